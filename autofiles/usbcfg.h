@@ -4,12 +4,55 @@
 #define USBCFG_H
 
 /** D E F I N I T I O N S *******************************************/
-#define EP0_BUFF_SIZE           8   // 8, 16, 32, or 64
-#define MAX_NUM_INT             1   // For tracking Alternate Setting
+/*
+ * Define for a full-speed device, with 1 ms keyboard polling.
+ * The configuration bits must then give the USB module the 48MHz
+ * PLL clock; low speed runs it from the 6MHz primary oscillator.
+ */
+//#define USB_FULL_SPEED
+
+#if defined(USB_FULL_SPEED)
+#define EP0_BUFF_SIZE           64  // 8, 16, 32, or 64
+#define USB_SPEED               _FS
+#define HID_INT_IN_INTERVAL     0x01    // 1 ms
+#else
+#define EP0_BUFF_SIZE           8   // Low speed allows only 8
+#define USB_SPEED               _LS
+#define HID_INT_IN_INTERVAL     0x0A    // 10 ms
+#endif
+
+/*
+ * Define for an N-key rollover bitmap report under the report
+ * protocol.  The boot protocol still gets the standard 6 key report.
+ * The bitmap needs a bigger endpoint than low speed allows.
+ */
+//#define USB_USE_NKRO
+
+/*
+ * Define to run USBDriverService from the high priority interrupt,
+ * with the keyboard readers at low priority, rather than polling it
+ * from the main loop.  Control transfers are then answered at once,
+ * however long UserTasks takes.
+ */
+//#define USB_INTERRUPT
 
-/* Parameter definitions are defined in usbdrv.h */
-#define MODE_PP                 _PPBM0
-#define UCFG_VAL                _PUEN|_TRINT|_LS|MODE_PP
+/*
+ * Define to end the report protocol keyboard report with when the key
+ * transition it reflects was detected: Timer0, 16 bits of 16/3 us.
+ * The longer report needs full speed.
+ */
+//#define USB_USE_TIMESTAMPS
+
+#define MAX_NUM_INT             2   // For tracking Alternate Setting
+
+/*
+ * Parameter definitions are defined in usbdrv.h
+ * Ping-pong on every endpoint but EP0, so that the next report can be
+ * staged while the SIE owns the other buffer.  The BDT layout in
+ * usbmmap.c depends on this.
+ */
+#define MODE_PP                 _PPBM3
+#define UCFG_VAL                _PUEN|_TRINT|USB_SPEED|MODE_PP
 
 #define usb_bus_sense           1
 #define self_power              0
@@ -34,35 +77,76 @@
 
 /* HID */
 #define HID_INTF_ID             0x00
+#define HID_EP                  1
 #define HID_UEP                 UEP1
-#define HID_BD_OUT              ep1Bo
 #define HID_INT_OUT_EP_SIZE     8
-#define HID_BD_IN               ep1Bi
-#define HID_INT_IN_EP_SIZE      8
+#define HID_BD_IN_EVEN          ep1BiE
+#define HID_BD_IN_ODD           ep1BiO
+#if defined(USB_USE_TIMESTAMPS)
+#define HID_TIMESTAMP_SIZE      2
+#define HID_TIMESTAMP_DSC_SIZE  18
+#else
+#define HID_TIMESTAMP_SIZE      0
+#define HID_TIMESTAMP_DSC_SIZE  0
+#endif
+#if defined(USB_USE_NKRO)
+#define HID_INT_IN_EP_SIZE      (32 + HID_TIMESTAMP_SIZE)
+#define HID_NUM_OF_DSC          1
+#define HID_RPT01_SIZE          (83 + HID_TIMESTAMP_DSC_SIZE)
+#else
+#define HID_INT_IN_EP_SIZE      (8 + HID_TIMESTAMP_SIZE)
 #define HID_NUM_OF_DSC          1
-#define HID_RPT01_SIZE          78
-#define HID_FEATURE_SIZE        2
+#define HID_RPT01_SIZE          (103 + HID_TIMESTAMP_DSC_SIZE)
+#endif
+#define HID_FEATURE_SIZE        7
+
+/* Vendor HID: one input report per Lisp keysym event */
+#define HID_VND_INTF_ID         0x01
+#define HID_VND_EP              2
+#define HID_VND_UEP             UEP2
+#define HID_VND_BD_IN_EVEN      ep2BiE
+#define HID_VND_BD_IN_ODD       ep2BiO
+#define HID_VND_INT_IN_EP_SIZE  8
+#define HID_RPT02_SIZE          35
+#define HID_VND_FEATURE_SIZE    26
 
 /* HID macros */
+#define mUSBHaltInEP(ep,halt)               HIDHaltInEP(ep,halt)
+
 #define mUSBGetHIDDscAdr(ptr)               \
 {                                           \
     if(usb_active_cfg == 1)                 \
-        ptr = (rom byte*)&cfg01.hid_i00a00; \
+    {                                       \
+        if(SetupPkt.bIntfID == HID_VND_INTF_ID) \
+            ptr = (rom byte*)&cfg01.hid_i01a00; \
+        else                                \
+            ptr = (rom byte*)&cfg01.hid_i00a00; \
+    }                                       \
 }
 
 #define mUSBGetHIDRptDscAdr(ptr)            \
 {                                           \
     if(usb_active_cfg == 1)                 \
-        ptr = (rom byte*)&hid_rpt01;        \
+    {                                       \
+        if(SetupPkt.bIntfID == HID_VND_INTF_ID) \
+            ptr = (rom byte*)&hid_rpt02;    \
+        else                                \
+            ptr = (rom byte*)&hid_rpt01;    \
+    }                                       \
 }
 
 #define mUSBGetHIDRptDscSize(count)         \
 {                                           \
     if(usb_active_cfg == 1)                 \
-        count = sizeof(hid_rpt01);          \
+    {                                       \
+        if(SetupPkt.bIntfID == HID_VND_INTF_ID) \
+            count = sizeof(hid_rpt02);      \
+        else                                \
+            count = sizeof(hid_rpt01);      \
+    }                                       \
 }
 
 
-#define MAX_EP_NUMBER           1           // UEP1
+#define MAX_EP_NUMBER           2           // UEP2
 
 #endif //USBCFG_H
@@ -170,7 +170,7 @@ CFG01={
     sizeof(USB_CFG_DSC),    // Size of this descriptor in bytes
     DSC_CFG,                // CONFIGURATION descriptor type
     sizeof(cfg01),          // Total length of data for this cfg
-    1,                      // Number of interfaces in this cfg
+    2,                      // Number of interfaces in this cfg
     1,                      // Index value of this configuration
     0,                      // Configuration string index
     0,                      // Attributes, see usbdefs_std_dsc.h
@@ -197,7 +197,30 @@ CFG01={
     sizeof(hid_rpt01),      // Size of the report descriptor
 
     /* Endpoint Descriptors */
-    sizeof(USB_EP_DSC),DSC_EP,_EP01_IN,_INT,HID_INT_IN_EP_SIZE,0x0A
+    sizeof(USB_EP_DSC),DSC_EP,_EP01_IN,_INT,HID_INT_IN_EP_SIZE,HID_INT_IN_INTERVAL,
+
+    /* Interface Descriptor: vendor keysym events */
+    sizeof(USB_INTF_DSC),   // Size of this descriptor in bytes
+    DSC_INTF,               // INTERFACE descriptor type
+    1,                      // Interface Number
+    0,                      // Alternate Setting Number
+    1,                      // Number of endpoints in this intf
+    HID_INTF,               // Class code
+    0,                      // Subclass code
+    HID_PROTOCOL_NONE,      // Protocol code
+    0,                      // Interface string index
+    
+    /* HID Class-Specific Descriptor */
+    sizeof(USB_HID_DSC),    // Size of this descriptor in bytes
+    DSC_HID,                // HID descriptor type
+    0x0101,                 // HID Spec Release Number in BCD format
+    0x00,                   // Country Code (0x00 for Not supported)
+    HID_NUM_OF_DSC,         // Number of class descriptors, see usbcfg.h
+    DSC_RPT,                // Report descriptor type
+    sizeof(hid_rpt02),      // Size of the report descriptor
+
+    /* Endpoint Descriptors */
+    sizeof(USB_EP_DSC),DSC_EP,_EP02_IN,_INT,HID_VND_INT_IN_EP_SIZE,HID_INT_IN_INTERVAL
 };
     
 rom struct{byte bLength;byte bDscType;word string[1];}sd000={
@@ -215,6 +238,27 @@ rom struct{byte report[HID_RPT01_SIZE];}hid_rpt01={
     0x05, 0x01, /* 		Usage Page (Generic Desktop)        */
     0x09, 0x06, /*		Usage (Keyboard)                    */
     0xA1, 0x01, /*		Collection (Application)            */
+#if defined(USB_USE_NKRO)
+    0x05, 0x07, /*  	Usage Page (Key codes)              */
+    0x19, 0x00, /*      Usage Minimum (0)                   */
+    0x2A, 0xFF,
+          0x00, /*      Usage Maximum (255)                 */
+    0x15, 0x00, /*      Logical Minimum (0)                 */
+    0x25, 0x01, /*      Logical Maximum (1)                 */
+    0x75, 0x01, /*      Report Size (1)                     */
+    0x96, 0x00,
+          0x01, /*      Report Count (256)                  */
+    0x81, 0x02, /*      Input (Data, Variable, Absolute)    */
+    0x95, 0x05, /*      Report Count (5)                    */
+    0x75, 0x01, /*      Report Size (1)                     */
+    0x05, 0x08, /*      Usage Page (Page# for LEDs)         */
+    0x19, 0x01, /*      Usage Minimum (1)                   */
+    0x29, 0x05, /*      Usage Maximum (5)                   */
+    0x91, 0x02, /*      Output (Data, Variable, Absolute)   */
+    0x95, 0x01, /*      Report Count (1)                    */
+    0x75, 0x03, /*      Report Size (3)                     */
+    0x91, 0x01, /*      Output (Constant)   ;LED padding    */
+#else
     0x05, 0x07, /*  	Usage Page (Key codes)              */
     0x19, 0xE0, /*      Usage Minimum (224)                 */
     0x29, 0xE7, /*      Usage Maximum (231)                 */
@@ -243,16 +287,68 @@ rom struct{byte report[HID_RPT01_SIZE];}hid_rpt01={
     0x19, 0x00, /*      Usage Minimum (00)                  */
     0x29, 0xDF, /*      Usage Maximum (223)                 */
     0x81, 0x00, /*      Input (Data, Array)                 */
+#endif
+#if defined(USB_USE_TIMESTAMPS)
     0x06, 0x01, 
           0xFF, /*      Usage Page (vendor)                 */
+    0x09, 0x0B, /*      Usage (0B)           ;Timestamp     */
+    0x15, 0x00, /*      Logical Minimum (0)                 */
+    0x27, 0xFF,
+          0xFF,
+          0x00,
+          0x00, /*      Logical Maximum (65535)             */
+    0x75, 0x10, /*      Report Size (16)                    */
+    0x95, 0x01, /*      Report Count (1)                    */
+    0x81, 0x02, /*      Input (Data, Variable, Absolute)    */
+#endif
+    0x06, 0x01, 
+          0xFF, /*      Usage Page (vendor)                 */
+    0x15, 0x00, /*      Logical Minimum (0)                 */
+    0x26, 0xFF,
+          0x00, /*      Logical Maximum (255)               */
     0x95, 0x01, /*      Report Count (1)                    */
     0x75, 0x08, /*      Report Size (8)                     */
     0x09, 0x01, /*      Usage (01)                          */
     0xB1, 0x03, /*      Feature (Constant, Variable) ;Keyboard type */
     0x09, 0x02, /*      Usage (02)                          */
     0xB1, 0x02, /*      Feature (Variable)   ;Keyboard mode */
+    0x09, 0x07, /*      Usage (07)                          */
+    0xB1, 0x02, /*      Feature (Variable)   ;Scan period ms */
+    0x09, 0x08, /*      Usage (08)                          */
+    0xB1, 0x02, /*      Feature (Variable)   ;Scan jitter   */
+    0x09, 0x09, /*      Usage (09)                          */
+    0xB1, 0x02, /*      Feature (Variable)   ;Debounce ms   */
+    0x09, 0x0C, /*      Usage (0C)                          */
+    0xB1, 0x02, /*      Feature (Variable)   ;Repeat delay  */
+    0x09, 0x0D, /*      Usage (0D)                          */
+    0xB1, 0x02, /*      Feature (Variable)   ;Repeat interval */
     0xC0};      /* 		End Collection                      */
 
+// One report per keysym event: modifiers, index in the keyboard's
+// sorted keysym table (0 for none), and the key's usage for when
+// there is no keysym.  Also a feature report of performance counters,
+// laid out in user.c.
+rom struct{byte report[HID_RPT02_SIZE];}hid_rpt02={
+    0x06, 0x01, 
+          0xFF, /*      Usage Page (vendor)                 */
+    0x09, 0x03, /*      Usage (03)           ;Keysym events */
+    0xA1, 0x01, /*      Collection (Application)            */
+    0x85, 0x01, /*      Report ID (1)                       */
+    0x15, 0x00, /*      Logical Minimum (0)                 */
+    0x26, 0xFF,
+          0x00, /*      Logical Maximum (255)               */
+    0x75, 0x08, /*      Report Size (8)                     */
+    0x95, 0x03, /*      Report Count (3)                    */
+    0x09, 0x04, /*      Usage (04)           ;Modifiers     */
+    0x09, 0x05, /*      Usage (05)           ;Keysym index  */
+    0x09, 0x06, /*      Usage (06)           ;Key usage     */
+    0x81, 0x02, /*      Input (Data, Variable, Absolute)    */
+    0x85, 0x02, /*      Report ID (2)                       */
+    0x95, 0x19, /*      Report Count (25)                   */
+    0x09, 0x0A, /*      Usage (0A)           ;Perf counters */
+    0xB1, 0x03, /*      Feature (Constant, Variable)        */
+    0xC0};      /*      End Collection                      */
+
 rom const unsigned char *rom USB_CD_Ptr[]={&cfg01,&cfg01};
 rom const unsigned char *rom USB_SD_Ptr[]={&sd000,&sd001,&sd002};
 
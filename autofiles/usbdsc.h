@@ -24,6 +24,9 @@
     USB_INTF_DSC    i00a00;         \
     USB_HID_DSC     hid_i00a00;     \
     USB_EP_DSC      ep01i_i00a00;   \
+    USB_INTF_DSC    i01a00;         \
+    USB_HID_DSC     hid_i01a00;     \
+    USB_EP_DSC      ep02i_i01a00;   \
 } cfg01
 
 /** E X T E R N S ***************************************************/
@@ -33,6 +36,7 @@ extern rom const unsigned char *rom USB_CD_Ptr[];
 extern rom const unsigned char *rom USB_SD_Ptr[];
 
 extern rom struct{byte report[HID_RPT01_SIZE];} hid_rpt01;
+extern rom struct{byte report[HID_RPT02_SIZE];} hid_rpt02;
 extern rom pFunc ClassReqHandler[1];
 
 #endif //USBDSC_H
@@ -29,6 +29,11 @@
 
 #define InitPortC() TRISC = 0x00;
 
+// TI Explorer keyboard serial data in on RX (RC7).  SPBRG for the baud
+// rate at 48MHz with BRG16 and BRGH: Fosc / (4 * baud) - 1.
+#define TI_BAUD 1200
+#define TI_SPBRG (48000000 / (4L * TI_BAUD) - 1)
+
 
 #define InitPorts() InitPortA(); InitPortB(); InitPortC();
 
@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""Generate the key tables from keymap/lmkbd.keys.
+
+Writes the firmware KeyInfo and keysym tables (user/keytables.c and
+.h), the host's usage to key code KeyMappings (usim/lmkbdkeys.h) and
+the keysym lists for Emacs (xemacs/lmkbd-keys.el).  Run from anywhere;
+paths are relative to the repository.
+"""
+
+import os
+import sys
+
+TOP = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+N_LEVELS = 3
+
+GENERATED = "Generated by keymap/genkeys.py from keymap/lmkbd.keys.  Do not edit."
+
+
+class Key:
+    def __init__(self, code, kind, usage, arg, legend):
+        self.code = code
+        self.kind = kind
+        self.usage = usage
+        self.arg = arg
+        self.legend = legend
+        self.keysyms = [None] * N_LEVELS
+        if kind != "shift" and arg != "-":
+            names = arg.split(",")
+            for level in range(N_LEVELS):
+                name = names[min(level, len(names) - 1)]
+                self.keysyms[level] = name or None
+
+
+class Keyboard:
+    def __init__(self, name, table, size):
+        self.name = name
+        self.table = table
+        self.size = size
+        self.keys = {}
+
+
+def error(filename, lineno, message):
+    sys.exit("%s:%d: %s" % (filename, lineno, message))
+
+
+def read_spec(filename):
+    keyboards = []
+    unicodes = []
+    usages = {}
+    section = None
+    with open(filename, encoding="utf-8") as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.rstrip("\n")
+            if not line.strip() or line.startswith("#"):
+                continue
+            if line.startswith("["):
+                words = line.strip("[]").split()
+                section = words[0]
+                if section == "keyboard":
+                    if len(words) != 4:
+                        error(filename, lineno, "bad keyboard header")
+                    keyboards.append(Keyboard(words[1], words[2],
+                                              int(words[3])))
+                elif section not in ("keysyms", "usages"):
+                    error(filename, lineno, "unknown section " + section)
+                continue
+            if section == "keyboard":
+                fields = line.split(None, 4)
+                if len(fields) < 4:
+                    error(filename, lineno, "too few fields")
+                code = int(fields[0], 8)
+                kind = fields[1]
+                if kind not in ("shift", "pc", "lisp"):
+                    error(filename, lineno, "unknown kind " + kind)
+                keyboard = keyboards[-1]
+                if code >= keyboard.size or code in keyboard.keys:
+                    error(filename, lineno, "bad or duplicate code")
+                legend = fields[4].strip() if len(fields) > 4 else ""
+                keyboard.keys[code] = Key(fields[0], kind, int(fields[2], 16),
+                                          fields[3], legend)
+            elif section == "keysyms":
+                name, code = line.split()
+                unicodes.append((name, int(code, 16)))
+            elif section == "usages":
+                fields = line.split(None, 1)
+                usages[int(fields[0], 16)] = \
+                    fields[1].strip() if len(fields) > 1 else ""
+            else:
+                error(filename, lineno, "not in a section")
+    return keyboards, unicodes, usages
+
+
+def write(path, text):
+    with open(os.path.join(TOP, path), "w", encoding="utf-8",
+              newline="\n") as f:
+        f.write(text)
+
+
+def all_keysyms(keyboards):
+    names = set()
+    for keyboard in keyboards:
+        for key in keyboard.keys.values():
+            names.update(k for k in key.keysyms if k)
+    # Sorted, so that the index is the same everywhere.
+    return sorted(names)
+
+
+def fill(items, indent, width=72):
+    lines = []
+    line = indent
+    for item in items:
+        if len(line) + len(item) + 1 > width and line.strip():
+            lines.append(line.rstrip())
+            line = indent
+        line += item + " "
+    lines.append(line.rstrip())
+    return "\n".join(lines)
+
+
+def firmware(keyboards, keysyms):
+    h = ["/* %s */\n" % GENERATED,
+         "\n#ifndef KEYTABLES_H\n#define KEYTABLES_H\n\n",
+         "#define N_KEYSYMS %d          // Including 0, no keysym.\n\n"
+         % (len(keysyms) + 1)]
+    for i, name in enumerate(keysyms, 1):
+        h.append("#define KS_%s %d\n" % (name, i))
+    h.append("\nextern rom const char *rom Keysyms[N_KEYSYMS];\n")
+    h.append("extern rom const unsigned char KeysymLengths[N_KEYSYMS];\n\n")
+    for keyboard in keyboards:
+        h.append("extern rom KeyInfo %s[%d];\n" % (keyboard.table, keyboard.size))
+    h.append("\n#endif //KEYTABLES_H\n")
+    write("user/keytables.h", "".join(h))
+
+    c = ["/* %s */\n\n" % GENERATED,
+         '#include "system\\typedefs.h"\n',
+         '#include "user\\keys.h"\n\n',
+         "#pragma romdata\n\n",
+         "// Sorted keysym names and their lengths.\n",
+         "rom const char *rom Keysyms[N_KEYSYMS] = {\n",
+         fill(['"",'] + ['"%s",' % k for k in keysyms], "  ")[:-1],
+         "\n};\n\n",
+         "rom const unsigned char KeysymLengths[N_KEYSYMS] = {\n",
+         fill(["0,"] + ["%d," % len(k) for k in keysyms], "  ")[:-1],
+         "\n};\n"]
+    for keyboard in keyboards:
+        c.append("\nrom KeyInfo %s[%d] = {\n" % (keyboard.table, keyboard.size))
+        width = len("%o" % (keyboard.size - 1))
+        for code in range(keyboard.size):
+            idx = "%0*o" % (width, code)
+            key = keyboard.keys.get(code)
+            if key is None:
+                entry = "NO_KEY(%s)" % idx
+            elif key.kind == "shift":
+                entry = "SHIFT_KEY(%s, 0x%02X, %s)" % (idx, key.usage, key.arg)
+            else:
+                entry = "%s(%s, 0x%02X, %s)" % (
+                    "PC_KEY" if key.kind == "pc" else "LISP_KEY",
+                    idx, key.usage,
+                    ", ".join("KS_" + k if k else "0" for k in key.keysyms))
+            if code < keyboard.size - 1:
+                entry += ","
+            if key is not None and key.legend:
+                entry = "%-30s /* %s */" % (entry, key.legend)
+            c.append("  " + entry + "\n")
+        c.append("};\n")
+    write("user/keytables.c", "".join(c))
+
+
+def host(keyboards, usages):
+    mappings = [[0xFF] * len(keyboards) for _ in range(256)]
+    for column, keyboard in enumerate(keyboards):
+        for code in sorted(keyboard.keys):
+            # Later codes win, as described in the spec.
+            mappings[keyboard.keys[code].usage][column] = code
+    h = ["/* %s */\n\n" % GENERATED,
+         "// Indexed by HUT page 7 usage id, give the original key codes for\n",
+         "// each keyboards.\n",
+         "static unsigned char KeyMappings[256][%d] = {\n" % len(keyboards)]
+    for usage in range(256):
+        codes = ", ".join("0xFF" if code == 0xFF else "%04o" % code
+                          for code in mappings[usage])
+        name = usages.get(usage, "")
+        comment = "/* %02X %s */" % (usage, name) if name else "/* %02X */" % usage
+        h.append("  { %s }%s   %s\n" % (codes, "," if usage < 255 else " ",
+                                        comment))
+    h.append("};\n")
+    write("usim/lmkbdkeys.h", "".join(h))
+
+
+def emacs(keysyms, unicodes):
+    el = [";;; -*- Mode: Emacs-Lisp; coding: utf-8 -*-\n",
+          ";;; %s\n\n" % GENERATED,
+          "(defconst lmkbd-unicode-keysyms\n  '("]
+    for i, (name, code) in enumerate(unicodes):
+        entry = "(%s . #x%04X)" % (name, code)
+        if i > 0:
+            el.append("\n    ")
+        el.append("%-24s;%s" % (entry, chr(code)))
+    el.append(")\n  \"Keysyms that are graphic characters, with their Unicode.\")\n\n")
+    el.append("(defconst lmkbd-keysyms\n")
+    el.append(fill(["[nil"] + keysyms, "  ", 70).replace("\n  ", "\n   ") + "]\n")
+    el.append("  \"Keysyms in the order the keyboard numbers them.\")\n\n")
+    el.append("(provide 'lmkbd-keys)\n")
+    write("xemacs/lmkbd-keys.el", "".join(el))
+
+
+def main():
+    keyboards, unicodes, usages = read_spec(os.path.join(TOP, "keymap",
+                                                         "lmkbd.keys"))
+    keysyms = all_keysyms(keyboards)
+    if len(keysyms) > 255:
+        sys.exit("too many keysyms for a byte")
+    names = set(keysyms)
+    for name, code in unicodes:
+        if name not in names:
+            sys.exit("keysym %s is not on any key" % name)
+    firmware(keyboards, keysyms)
+    host(keyboards, usages)
+    emacs(keysyms, unicodes)
+
+
+if __name__ == "__main__":
+    main()
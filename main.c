@@ -27,11 +27,26 @@ void main(void)
 static void SystemInit(void)
 {
   mInitializeUSBDriver();
+#if defined(USB_INTERRUPT)
+  // USB at high priority; everything else, the keyboards, low.
+  RCONbits.IPEN = 1;
+  IPR1 = 0;
+  IPR2 = 0;
+  INTCON2 &= ~0x07;             // TMR0IP, RBIP.
+  INTCON3 &= ~0xC0;             // INT2IP, INT1IP.
+  IPR2bits.USBIP = 1;
+  PIR2bits.USBIF = 0;
+  PIE2bits.USBIE = 1;
+  INTCONbits.GIEL = 1;
+  INTCONbits.GIEH = 1;
+#endif
 }
 
 static void SystemTasks(void)
 {
   USBCheckBusStatus();          // Must use polling method
+#if !defined(USB_INTERRUPT)
   if (UCFGbits.UTEYE!=1)
     USBDriverService();         // Interrupt or polling method
+#endif
 }
@@ -0,0 +1,7 @@
+// Forced ahead of every firmware source in the simulation build, so
+// that C18's storage qualifiers compile away under gcc.
+
+#define rom
+#define ram
+#define near
+#define far
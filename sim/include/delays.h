@@ -0,0 +1,15 @@
+// C18 delay library, for the simulation: each call just counts its
+// cycles against the simulated clock.
+
+#ifndef DELAYS_H
+#define DELAYS_H
+
+void SimDelayCycles(unsigned long cycles);
+
+#define Delay1TCY() SimDelayCycles(1)
+#define Delay10TCYx(n) SimDelayCycles(10UL * (n))
+#define Delay100TCYx(n) SimDelayCycles(100UL * (n))
+#define Delay1KTCYx(n) SimDelayCycles(1000UL * (n))
+#define Delay10KTCYx(n) SimDelayCycles(10000UL * (n))
+
+#endif //DELAYS_H
@@ -0,0 +1,131 @@
+// Mock PIC18F2550 special function registers, for running the firmware
+// on the host.  Only the registers and bits the simulated sources use
+// are here.  Each is a union of the whole byte and its bits, as in
+// C18's own header, and sim.c defines the storage.  PORTB and RCREG
+// are read through sim.c, so that a read can see the keyboard's
+// current data bit or take the next received byte.
+
+#ifndef P18CXXX_H
+#define P18CXXX_H
+
+#ifndef SIM_SFR_STORAGE
+#define SIM_SFR_STORAGE extern
+#endif
+
+#define SIM_SFR(name, bits)                     \
+  typedef union {                               \
+    unsigned char _byte;                        \
+    struct { bits };                            \
+  } Sim##name##_t;                              \
+  SIM_SFR_STORAGE volatile Sim##name##_t Sim##name;
+
+#define SIM_BYTE(name) SIM_SFR_STORAGE volatile unsigned char name;
+
+SIM_SFR(INTCON, unsigned RBIF:1; unsigned INT0IF:1; unsigned TMR0IF:1;
+        unsigned RBIE:1; unsigned INT0IE:1; unsigned TMR0IE:1;
+        unsigned PEIE:1; unsigned GIE:1;)
+SIM_SFR(INTCON2, unsigned RBIP:1; unsigned :1; unsigned TMR0IP:1;
+        unsigned :1; unsigned INTEDG2:1; unsigned INTEDG1:1;
+        unsigned INTEDG0:1; unsigned RBPU:1;)
+SIM_SFR(INTCON3, unsigned INT1IF:1; unsigned INT2IF:1; unsigned :1;
+        unsigned INT1IE:1; unsigned INT2IE:1; unsigned :1;
+        unsigned INT1IP:1; unsigned INT2IP:1;)
+SIM_SFR(PIR1, unsigned TMR1IF:1; unsigned TMR2IF:1; unsigned CCP1IF:1;
+        unsigned SSPIF:1; unsigned TXIF:1; unsigned RCIF:1;
+        unsigned ADIF:1; unsigned SPPIF:1;)
+SIM_SFR(PIE1, unsigned TMR1IE:1; unsigned TMR2IE:1; unsigned CCP1IE:1;
+        unsigned SSPIE:1; unsigned TXIE:1; unsigned RCIE:1;
+        unsigned ADIE:1; unsigned SPPIE:1;)
+SIM_SFR(PIR2, unsigned CCP2IF:1; unsigned TMR3IF:1; unsigned HLVDIF:1;
+        unsigned BCLIF:1; unsigned EEIF:1; unsigned USBIF:1;
+        unsigned CMIF:1; unsigned OSCFIF:1;)
+SIM_SFR(PIE2, unsigned CCP2IE:1; unsigned TMR3IE:1; unsigned HLVDIE:1;
+        unsigned BCLIE:1; unsigned EEIE:1; unsigned USBIE:1;
+        unsigned CMIE:1; unsigned OSCFIE:1;)
+SIM_SFR(LATA, unsigned LATA0:1; unsigned LATA1:1; unsigned LATA2:1;
+        unsigned LATA3:1; unsigned LATA4:1; unsigned LATA5:1;
+        unsigned LATA6:1; unsigned :1;)
+SIM_SFR(LATC, unsigned LATC0:1; unsigned LATC1:1; unsigned LATC2:1;
+        unsigned :3; unsigned LATC6:1; unsigned LATC7:1;)
+SIM_SFR(PORTB, unsigned RB0:1; unsigned RB1:1; unsigned RB2:1;
+        unsigned RB3:1; unsigned RB4:1; unsigned RB5:1;
+        unsigned RB6:1; unsigned RB7:1;)
+SIM_SFR(TRISC, unsigned TRISC0:1; unsigned TRISC1:1; unsigned TRISC2:1;
+        unsigned :3; unsigned TRISC6:1; unsigned TRISC7:1;)
+SIM_SFR(T1CON, unsigned TMR1ON:1; unsigned TMR1CS:1; unsigned NOT_T1SYNC:1;
+        unsigned T1OSCEN:1; unsigned T1CKPS0:1; unsigned T1CKPS1:1;
+        unsigned T1RUN:1; unsigned RD16:1;)
+SIM_SFR(T2CON, unsigned T2CKPS0:1; unsigned T2CKPS1:1; unsigned TMR2ON:1;
+        unsigned T2OUTPS0:1; unsigned T2OUTPS1:1; unsigned T2OUTPS2:1;
+        unsigned T2OUTPS3:1; unsigned :1;)
+SIM_SFR(RCSTA, unsigned RX9D:1; unsigned OERR:1; unsigned FERR:1;
+        unsigned ADDEN:1; unsigned CREN:1; unsigned SREN:1;
+        unsigned RX9:1; unsigned SPEN:1;)
+SIM_SFR(BAUDCON, unsigned ABDEN:1; unsigned WUE:1; unsigned :1;
+        unsigned BRG16:1; unsigned TXCKP:1; unsigned RXDTP:1;
+        unsigned RCIDL:1; unsigned ABDOVF:1;)
+SIM_SFR(UCON, unsigned :1; unsigned SUSPND:1; unsigned RESUME:1;
+        unsigned USBEN:1; unsigned PKTDIS:1; unsigned SE0:1;
+        unsigned PPBRST:1; unsigned :1;)
+
+#define INTCON SimINTCON._byte
+#define INTCONbits SimINTCON
+#define INTCON2 SimINTCON2._byte
+#define INTCON2bits SimINTCON2
+#define INTCON3 SimINTCON3._byte
+#define INTCON3bits SimINTCON3
+#define PIR1 SimPIR1._byte
+#define PIR1bits SimPIR1
+#define PIE1 SimPIE1._byte
+#define PIE1bits SimPIE1
+#define PIR2 SimPIR2._byte
+#define PIR2bits SimPIR2
+#define PIE2 SimPIE2._byte
+#define PIE2bits SimPIE2
+#define LATA SimLATA._byte
+#define LATAbits SimLATA
+#define LATC SimLATC._byte
+#define LATCbits SimLATC
+#define TRISC SimTRISC._byte
+#define TRISCbits SimTRISC
+#define T1CON SimT1CON._byte
+#define T1CONbits SimT1CON
+#define T2CON SimT2CON._byte
+#define T2CONbits SimT2CON
+#define RCSTA SimRCSTA._byte
+#define RCSTAbits SimRCSTA
+#define BAUDCON SimBAUDCON._byte
+#define BAUDCONbits SimBAUDCON
+#define UCON SimUCON._byte
+#define UCONbits SimUCON
+
+volatile SimPORTB_t *SimReadPORTB(void);
+unsigned char SimReadRCREG(void);
+
+#define PORTB (SimReadPORTB()->_byte)
+#define PORTBbits (*SimReadPORTB())
+#define RCREG SimReadRCREG()
+
+SIM_BYTE(ADCON1)
+SIM_BYTE(TRISA)
+SIM_BYTE(TRISB)
+SIM_BYTE(T0CON)
+SIM_BYTE(TMR0L)
+SIM_BYTE(TMR0H)
+SIM_BYTE(TMR1L)
+SIM_BYTE(TMR1H)
+SIM_BYTE(TMR2)
+SIM_BYTE(PR2)
+SIM_BYTE(CCP1CON)
+SIM_BYTE(CCPR1L)
+SIM_BYTE(CCPR1H)
+SIM_BYTE(TXSTA)
+SIM_BYTE(SPBRG)
+SIM_BYTE(SPBRGH)
+SIM_BYTE(UEP1)
+SIM_BYTE(UEP2)
+
+#define Nop()
+#define ClrWdt()
+
+#endif //P18CXXX_H
@@ -0,0 +1,2 @@
+// The firmware programs the EUSART registers itself; nothing is
+// needed from the C18 library.
@@ -0,0 +1,347 @@
+// Benchmark EMACS mode: type every keysym of the MIT and Symbolics
+// keyboards under each combination of shifts, through the simulated
+// keyboard protocols, and count the reports it takes and how long
+// until the last is delivered, at 10 ms and 1 ms polling.
+//
+//   ./lmkbdbench [-s]
+//
+// Each line is the keyboard, key code, keysym and shifts, then the
+// reports for key down and up and the time from key down until the
+// last report, at each polling interval.  A keysym that a key gives
+// at several levels is typed only at the lowest.  "doubled" marks
+// those that needed a report with no key between two with the same
+// one.  -s prints only the summary for each keyboard.
+
+#include "system/typedefs.h"
+#include "user/keys.h"
+#include "sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define N_POLLS 2
+static const unsigned Polls[N_POLLS] = { 10, 1 };
+
+#define QUIET_LIMIT SIM_MS(2000)
+
+// Shifts that Emacs mode sends as a prefix, and the levels.
+#define N_PREFIX_SHIFTS 5
+static const KeyShift PrefixShifts[N_PREFIX_SHIFTS] = {
+  L_CONTROL, L_META, L_SUPER, L_HYPER, L_SHIFT
+};
+static const char *const PrefixNames[N_PREFIX_SHIFTS] = {
+  "C-", "M-", "s-", "H-", "S-"
+};
+static const KeyShift LevelShifts[N_KEYSYM_LEVELS] = {
+  NONE, L_SYMBOL, L_GREEK
+};
+
+typedef struct {
+  const char *name;
+  SimKeyboard keyboard;
+  rom KeyInfo *keys;
+  int nkeys;
+} Keyboard;
+
+static const Keyboard Keyboards[] = {
+  { "tk", SIM_TK, TKKeys, 64 },
+  { "space-cadet", SIM_SPACE_CADET, SpaceCadetKeys, 128 },
+  { "smbx", SIM_SMBX, SMBXKeyInfos, 128 },
+};
+#define N_KEYBOARDS (sizeof(Keyboards) / sizeof(Keyboards[0]))
+
+typedef struct {
+  unsigned char code, level, combo;
+  unsigned reports[N_POLLS];
+  SimTime time[N_POLLS];
+  int doubled, timeout;
+} Case;
+
+#define MAX_CASES (128 * N_KEYSYM_LEVELS * (1 << N_PREFIX_SHIFTS))
+static Case Cases[MAX_CASES];
+
+// Reports seen while measuring, and the keys of the last two.
+static int measuring;
+static unsigned reportCount;
+static int doubled;
+static unsigned char lastKey, blankAfter;
+
+static void CountReport(SimTime when, int ep,
+                        const unsigned char *report, int len)
+{
+  if (!measuring)
+    return;
+  reportCount++;
+  if ((ep != 1) || (len < 3))
+    return;
+  // A blank report only to let the same key be seen again.
+  if ((lastKey == 0) && (blankAfter != 0) && (report[2] == blankAfter))
+    doubled = TRUE;
+  blankAfter = (report[2] == 0) ? lastKey : 0;
+  lastKey = report[2];
+}
+
+/**** Playing each keyboard ****/
+
+// MIT code bits for the shifts a TK sends with each key.
+static unsigned TKShiftBit(KeyShift shift)
+{
+  switch (shift) {
+  case L_SHIFT: return 1 << 6;
+  case L_SYMBOL: return 1 << 8;
+  case L_CONTROL: return 1 << 10;
+  case L_META: return 1 << 12;
+  default: return 0;
+  }
+}
+
+// Space Cadet all keys up mask bits for the shifts still held.
+static unsigned SpaceCadetShiftBit(KeyShift shift)
+{
+  switch (shift) {
+  case L_SHIFT: return 1 << 0;
+  case L_GREEK: return 1 << 1;
+  case L_SYMBOL: return 1 << 2;
+  case L_CONTROL: return 1 << 4;
+  case L_META: return 1 << 5;
+  case L_SUPER: return 1 << 6;
+  case L_HYPER: return 1 << 7;
+  default: return 0;
+  }
+}
+
+static int FindShiftKey(const Keyboard *kbd, KeyShift shift)
+{
+  int code;
+
+  for (code = 0; code < kbd->nkeys; code++) {
+    if (kbd->keys[code].shift == shift)
+      return code;
+  }
+  return -1;
+}
+
+// Whether the keyboard can type with this shift.
+static int HasShift(const Keyboard *kbd, KeyShift shift)
+{
+  if (shift == NONE)
+    return TRUE;
+  if (kbd->keyboard == SIM_TK)
+    return TKShiftBit(shift) != 0;
+  return FindShiftKey(kbd, shift) >= 0;
+}
+
+static void Quiet(Case *c)
+{
+  if (!SimQuiet() && (SimRunUntilQuiet(QUIET_LIMIT) >= QUIET_LIMIT))
+    c->timeout = TRUE;
+}
+
+static void ShiftKey(const Keyboard *kbd, KeyShift shift, int down, Case *c)
+{
+  int code = FindShiftKey(kbd, shift);
+
+  if (kbd->keyboard == SIM_SMBX)
+    SimSetSMBXKey(code, down);
+  else
+    SimQueueMIT(0xF90000 | (down ? 0 : 0x0100) | code);
+  Quiet(c);
+}
+
+// Type the key of a case with its shifts; return the time from key
+// down until all is reported.
+static SimTime Type(const Keyboard *kbd, const KeyShift *shifts, int nshifts,
+                    Case *c)
+{
+  SimTime start, elapsed;
+  unsigned mask = 0;
+  int i;
+
+  for (i = 0; i < nshifts; i++) {
+    if (kbd->keyboard == SIM_TK)
+      mask |= TKShiftBit(shifts[i]);
+    else {
+      mask |= SpaceCadetShiftBit(shifts[i]);
+      ShiftKey(kbd, shifts[i], TRUE, c);
+    }
+  }
+
+  measuring = TRUE;
+  reportCount = 0;
+  doubled = FALSE;
+  lastKey = blankAfter = 0;
+  start = SimNow();
+  switch (kbd->keyboard) {
+  case SIM_TK:
+    SimQueueMIT(0xFF0000 | ((mask >> 8) << 8) | (mask & 0xC0) | c->code);
+    break;
+  case SIM_SPACE_CADET:
+    SimQueueMIT(0xF90000 | c->code);
+    break;
+  default:
+    SimSetSMBXKey(c->code, TRUE);
+    break;
+  }
+  Quiet(c);
+  elapsed = SimNow() - start;
+
+  // The Space Cadet sends all keys up, with the shifts still held,
+  // for the last ordinary key.  The TK sends nothing.
+  switch (kbd->keyboard) {
+  case SIM_TK:
+    break;
+  case SIM_SPACE_CADET:
+    SimQueueMIT(0xF98000 | ((mask >> 8) << 8) | (mask & 0xFF));
+    break;
+  default:
+    SimSetSMBXKey(c->code, FALSE);
+    break;
+  }
+  Quiet(c);
+  measuring = FALSE;
+  c->doubled |= doubled;
+
+  for (i = nshifts - 1; i >= 0; i--) {
+    if (kbd->keyboard != SIM_TK)
+      ShiftKey(kbd, shifts[i], FALSE, c);
+  }
+  // Past the debounce window before the next key.
+  SimRun(SIM_MS(10));
+  return elapsed;
+}
+
+static int Walk(const Keyboard *kbd, int poll)
+{
+  int ncases = 0, code, level, combo, i, nshifts;
+  KeyShift shifts[N_PREFIX_SHIFTS + 1];
+
+  SimStart(kbd->keyboard);
+  SimSetFeature(1, 2);                  // EMACS.
+  SimSetProtocol(0);                    // Boot, for the 6 key layout.
+  SimSetPollInterval(Polls[poll]);
+  SimOnReport(CountReport);
+  SimRunUntilQuiet(QUIET_LIMIT);
+
+  for (code = 0; code < kbd->nkeys; code++) {
+    rom KeyInfo *key = &kbd->keys[code];
+    if (key->shift != NONE)
+      continue;
+    for (level = 0; level < N_KEYSYM_LEVELS; level++) {
+      if ((key->keysyms[level] == 0) || !HasShift(kbd, LevelShifts[level]))
+        continue;
+      // A keysym the key already gives at a lower level is one case.
+      for (i = 0; i < level; i++) {
+        if ((key->keysyms[i] == key->keysyms[level]) &&
+            HasShift(kbd, LevelShifts[i]))
+          break;
+      }
+      if (i < level)
+        continue;
+      for (combo = 0; combo < (1 << N_PREFIX_SHIFTS); combo++) {
+        Case *c = &Cases[ncases++];
+        nshifts = 0;
+        if (level > 0)
+          shifts[nshifts++] = LevelShifts[level];
+        for (i = 0; i < N_PREFIX_SHIFTS; i++) {
+          if (combo & (1 << i))
+            shifts[nshifts++] = PrefixShifts[i];
+        }
+        for (i = 0; i < nshifts; i++) {
+          if (!HasShift(kbd, shifts[i]))
+            break;
+        }
+        if (i < nshifts) {
+          ncases--;
+          continue;
+        }
+        if (poll == 0)
+          memset(c, 0, sizeof(*c));
+        c->code = code;
+        c->level = level;
+        c->combo = combo;
+        c->time[poll] = Type(kbd, shifts, nshifts, c);
+        c->reports[poll] = reportCount;
+      }
+    }
+  }
+  return ncases;
+}
+
+static double Milliseconds(SimTime cycles)
+{
+  return cycles * 1000.0 / SIM_FCY;
+}
+
+static void PrintCase(const Keyboard *kbd, const Case *c)
+{
+  char prefix[3 * N_PREFIX_SHIFTS + 1];
+  int i, p;
+
+  prefix[0] = '\0';
+  for (i = 0; i < N_PREFIX_SHIFTS; i++) {
+    if (c->combo & (1 << i))
+      strcat(prefix, PrefixNames[i]);
+  }
+  printf("%-11s %03o %-16s %-15s", kbd->name, c->code,
+         Keysyms[kbd->keys[c->code].keysyms[c->level]], prefix);
+  for (p = 0; p < N_POLLS; p++)
+    printf(" %3u %8.3f", c->reports[p], Milliseconds(c->time[p]));
+  if (c->doubled)
+    printf(" doubled");
+  if (c->timeout)
+    printf(" timeout");
+  printf("\n");
+}
+
+static void PrintSummary(const Keyboard *kbd, int ncases)
+{
+  unsigned long reports;
+  unsigned most;
+  SimTime total, longest;
+  int i, p, ndoubled = 0;
+
+  for (i = 0; i < ncases; i++) {
+    if (Cases[i].doubled)
+      ndoubled++;
+  }
+  printf("%s: %d cases, %d doubled\n", kbd->name, ncases, ndoubled);
+  for (p = 0; p < N_POLLS; p++) {
+    reports = most = 0;
+    total = longest = 0;
+    for (i = 0; i < ncases; i++) {
+      reports += Cases[i].reports[p];
+      if (Cases[i].reports[p] > most)
+        most = Cases[i].reports[p];
+      total += Cases[i].time[p];
+      if (Cases[i].time[p] > longest)
+        longest = Cases[i].time[p];
+    }
+    printf("  %2u ms polling: reports mean %.2f, most %u;"
+           " delivered mean %.3f ms, worst %.3f ms\n",
+           Polls[p], (double)reports / ncases, most,
+           Milliseconds(total) / ncases, Milliseconds(longest));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  int summary = (argc > 1) && !strcmp(argv[1], "-s");
+  int k, i, p, ncases = 0;
+
+  for (k = 0; k < N_KEYBOARDS; k++) {
+    for (p = 0; p < N_POLLS; p++)
+      ncases = Walk(&Keyboards[k], p);
+    if (!summary) {
+      printf("%-11s %-3s %-16s %-15s", "keyboard", "key", "keysym", "shifts");
+      for (p = 0; p < N_POLLS; p++)
+        printf(" %3s %5u ms", "rpt", Polls[p]);
+      printf("\n");
+      for (i = 0; i < ncases; i++)
+        PrintCase(&Keyboards[k], &Cases[i]);
+    }
+    PrintSummary(&Keyboards[k], ncases);
+    if (!summary)
+      printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,189 @@
+// Run the firmware on the host from a script of keyboard input, print
+// the reports it sends and sum up how many and how soon.
+//
+//   ./lmkbdsim [-q] [script]
+//
+// Reads standard input without a script.  One command a line; # starts
+// a comment.
+//
+//   keyboard tk|space-cadet|ti|smbx    Reset with this keyboard (tk).
+//   poll MS                            Host polling interval.
+//   loop US                            Time for a main loop pass (50).
+//   mode hut1|emacs|keysym             As the feature report sets it.
+//   protocol boot|report               As SET_PROTOCOL sets it.
+//   idle UNITS                         As SET_IDLE sets it, 4 ms units (0).
+//   feature INDEX VALUE                Any other feature byte.
+//   mit HEX                            Send a 24-bit MIT code.
+//   smbx down|up OCTAL                 Change a Symbolics matrix key.
+//   ti HEX                             Send an Explorer scan code.
+//   wait MS                            Let time pass.
+//   quiet [MS]                         Until all is reported (1000).
+//
+// At the end, runs until quiet.  -q prints only the summary.
+
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern unsigned short KeyEventsProcessed;
+
+static int started, quietReports;
+
+static double Milliseconds(SimTime cycles)
+{
+  return cycles * 1000.0 / SIM_FCY;
+}
+
+static void PrintReport(SimTime when, int ep,
+                        const unsigned char *report, int len)
+{
+  int i;
+
+  if (quietReports)
+    return;
+  printf("%10.3f ms  ep%d ", Milliseconds(when), ep);
+  for (i = 0; i < len; i++)
+    printf(" %02X", report[i]);
+  printf("\n");
+}
+
+static void Start(SimKeyboard keyboard)
+{
+  SimStart(keyboard);
+  started = 1;
+}
+
+static int Lookup(const char *word, const char *const *names, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    if ((word != NULL) && !strcmp(word, names[i]))
+      return i;
+  }
+  return -1;
+}
+
+static const char *const Keyboards[] = { "tk", "space-cadet", "ti", "smbx" };
+static const char *const Modes[] = { "", "hut1", "emacs", "keysym" };
+static const char *const Protocols[] = { "boot", "report" };
+static const char *const Directions[] = { "up", "down" };
+
+#define N(a) (sizeof(a) / sizeof(a[0]))
+
+static int Command(char *line)
+{
+  char *command, *arg1, *arg2;
+  int i;
+
+  command = strtok(line, " \t\r\n");
+  if ((command == NULL) || (command[0] == '#'))
+    return 0;
+  arg1 = strtok(NULL, " \t\r\n");
+  arg2 = strtok(NULL, " \t\r\n");
+
+  if (!strcmp(command, "keyboard")) {
+    if ((i = Lookup(arg1, Keyboards, N(Keyboards))) < 0)
+      return -1;
+    Start((SimKeyboard)i);
+    return 0;
+  }
+  if (!strcmp(command, "poll") && arg1) {
+    SimSetPollInterval(atoi(arg1));
+    return 0;
+  }
+  if (!strcmp(command, "loop") && arg1) {
+    SimSetLoopTime(atoi(arg1));
+    return 0;
+  }
+
+  if (!started)
+    Start(SIM_TK);
+
+  if (!strcmp(command, "mode")) {
+    if ((i = Lookup(arg1, Modes, N(Modes))) <= 0)
+      return -1;
+    SimSetFeature(1, i);
+  }
+  else if (!strcmp(command, "protocol")) {
+    if ((i = Lookup(arg1, Protocols, N(Protocols))) < 0)
+      return -1;
+    SimSetProtocol(i);
+  }
+  else if (!strcmp(command, "idle") && arg1)
+    SimSetIdle(atoi(arg1));
+  else if (!strcmp(command, "feature") && arg1 && arg2)
+    SimSetFeature(atoi(arg1), atoi(arg2));
+  else if (!strcmp(command, "mit") && arg1)
+    SimQueueMIT(strtoul(arg1, NULL, 16));
+  else if (!strcmp(command, "smbx")) {
+    if (((i = Lookup(arg1, Directions, N(Directions))) < 0) || !arg2)
+      return -1;
+    SimSetSMBXKey(strtoul(arg2, NULL, 8), i);
+  }
+  else if (!strcmp(command, "ti") && arg1)
+    SimQueueTI(strtoul(arg1, NULL, 16));
+  else if (!strcmp(command, "wait") && arg1)
+    SimRun(SIM_MS(atoi(arg1)));
+  else if (!strcmp(command, "quiet"))
+    SimRunUntilQuiet(SIM_MS(arg1 ? atoi(arg1) : 1000));
+  else
+    return -1;
+  return 0;
+}
+
+static void PrintSummary(void)
+{
+  unsigned long reports = SimStatistics.reports[0] + SimStatistics.reports[1];
+
+  printf("inputs %lu, key events %u, reports %lu keyboard + %lu vendor",
+         SimStatistics.inputs, KeyEventsProcessed,
+         SimStatistics.reports[0], SimStatistics.reports[1]);
+  if (SimStatistics.inputs > 0)
+    printf(", %.2f per input", (double)reports / SimStatistics.inputs);
+  printf("\n");
+  if (SimStatistics.latencies > 0)
+    printf("input to next report: mean %.3f ms, worst %.3f ms\n",
+           Milliseconds(SimStatistics.latencyTotal) / SimStatistics.latencies,
+           Milliseconds(SimStatistics.latencyMax));
+  printf("simulated %.3f ms, %lu main loop passes, %lu interrupts\n",
+         Milliseconds(SimNow()), SimStatistics.loops,
+         SimStatistics.interrupts);
+}
+
+int main(int argc, char **argv)
+{
+  FILE *script = stdin;
+  char line[256];
+  int lineno = 0;
+
+  if ((argc > 1) && !strcmp(argv[1], "-q")) {
+    quietReports = 1;
+    argc--;
+    argv++;
+  }
+  if (argc > 1) {
+    script = fopen(argv[1], "r");
+    if (script == NULL) {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  SimOnReport(PrintReport);
+  while (fgets(line, sizeof(line), script) != NULL) {
+    lineno++;
+    if (Command(line) < 0) {
+      fprintf(stderr, "%d: bad command\n", lineno);
+      return 1;
+    }
+  }
+  if (!started)
+    Start(SIM_TK);
+  SimRunUntilQuiet(SIM_MS(1000));
+
+  PrintSummary();
+  return 0;
+}
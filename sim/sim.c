@@ -0,0 +1,451 @@
+// Host simulation of the firmware: drives user.c's interrupt service
+// and main loop from a queue of timed events, plays the keyboards'
+// side of their protocols on the mock ports, and takes the reports the
+// firmware hands to the SIE the way the host's polling would.
+
+#define SIM_SFR_STORAGE
+#include <p18cxxx.h>
+#include "system/typedefs.h"
+#include "system/usb/usb.h"
+#include "user/user.h"
+#include "sim.h"
+
+#include <string.h>
+
+// Firmware state looked at to tell when everything has been reported.
+extern volatile unsigned char KeyEventIn, KeyEventOut;
+extern unsigned char EmacsBufferedCount;
+extern BOOL KeyReportPending;
+extern unsigned char smbxKeyStates[16];
+extern unsigned short KeyEventsProcessed;
+
+#define NEVER (~(SimTime)0)
+#define N_QUEUED 256                    // Must be a power of two.
+
+SimStats SimStatistics;
+
+static SimTime now;
+static SimTime nextLoop, nextTimer2, nextCCP1, nextTIByte, nextPoll;
+static SimTime loopCycles = SIM_US(50);
+static SimTime pollCycles = SIM_MS(HID_INT_IN_INTERVAL);
+static SimReportHandler reportHandler;
+static unsigned char keyboardSwitches;
+
+// MIT keyboards: codes waiting to be clocked out, and the one that is.
+static unsigned long mitFrames[N_QUEUED];
+static unsigned mitHead, mitTail;
+static unsigned long mitFrame;
+static int mitActive, mitBitsSent;
+static unsigned char mitData = 1, lastClock;
+
+// Symbolics matrix, as it will be read by the next scan.
+static unsigned char smbxMatrix[16];
+static int smbxReadIndex = -1;          // Key read next, while scanning.
+
+// TI Explorer: codes still to be sent, and what the EUSART holds.
+static unsigned char tiBytes[N_QUEUED];
+static unsigned tiHead, tiTail;
+static unsigned char rxFifo[2];
+static int rxCount;
+
+// When each input not yet followed by a report was made, and how many
+// key events have been accounted for so.
+static SimTime inputTimes[N_QUEUED];
+static unsigned inputHead, inputTail;
+static unsigned short eventsReported;
+
+// The SIE's next IN buffer on each endpoint: 0 even, 1 odd.
+static byte siePPBI[2];
+
+/**** Registers with side effects ****/
+
+volatile SimPORTB_t *SimReadPORTB(void)
+{
+  SimPORTB._byte = keyboardSwitches & 0x03;
+  SimPORTB.RB2 = mitData;
+  SimPORTB.RB3 = 1;
+  if ((smbxReadIndex >= 0) && (smbxReadIndex < 128)) {
+    // The matrix pulls the line low for a key that is down.
+    if (smbxMatrix[smbxReadIndex >> 3] & (1 << (smbxReadIndex & 7)))
+      SimPORTB.RB3 = 0;
+    smbxReadIndex++;
+  }
+  return &SimPORTB;
+}
+
+unsigned char SimReadRCREG(void)
+{
+  unsigned char result = rxFifo[0];
+
+  if (rxCount > 0) {
+    rxFifo[0] = rxFifo[1];
+    rxCount--;
+  }
+  if (rxCount == 0)
+    PIR1bits.RCIF = 0;
+  return result;
+}
+
+void SimDelayCycles(unsigned long cycles)
+{
+  now += cycles;
+}
+
+/**** Running the firmware ****/
+
+static void SyncTimers(void)
+{
+  unsigned long counts = now;
+
+  if (!(T0CON & 0x08))                  // Prescaler assigned.
+    counts >>= (T0CON & 0x07) + 1;
+  TMR0L = counts & 0xFF;
+  TMR0H = (counts >> 8) & 0xFF;
+}
+
+static SimTime Timer2Period(void)
+{
+  static const unsigned char prescale[4] = { 1, 4, 16, 16 };
+
+  return (SimTime)(PR2 + 1) * prescale[T2CON & 0x03] *
+    (((T2CON >> 3) & 0x0F) + 1);
+}
+
+static SimTime CCP1Period(void)
+{
+  unsigned short counts = ((unsigned short)CCPR1H << 8) | CCPR1L;
+
+  return (SimTime)(counts ? counts : 1) << ((T1CON >> 4) & 0x03);
+}
+
+static SimTime TIByteTime(void)
+{
+  unsigned short spbrg = ((unsigned short)SPBRGH << 8) | SPBRG;
+
+  // BRG16 and BRGH: a bit every SPBRG + 1 cycles; start, 8 data, stop.
+  return (SimTime)(spbrg + 1) * 10;
+}
+
+// Start or stop event sources after the firmware has run.
+static void Schedule(void)
+{
+  if (T2CONbits.TMR2ON && PIE1bits.TMR2IE) {
+    if (nextTimer2 == NEVER)
+      nextTimer2 = now + Timer2Period();
+  }
+  else
+    nextTimer2 = NEVER;
+
+  if (T1CONbits.TMR1ON && PIE1bits.CCP1IE && (CCP1CON == 0x0B)) {
+    if (nextCCP1 == NEVER)
+      nextCCP1 = now + CCP1Period();
+  }
+  else
+    nextCCP1 = NEVER;
+
+  if (RCSTAbits.SPEN && RCSTAbits.CREN && (tiHead != tiTail)) {
+    if (nextTIByte == NEVER)
+      nextTIByte = now + TIByteTime();
+  }
+  else
+    nextTIByte = NEVER;
+}
+
+// Follow the MIT clock line: the keyboard puts out the next bit of the
+// code when the clock falls, and lets the data line go high once the
+// last has been taken.
+static void WatchMIT(void)
+{
+  unsigned char clock = LATCbits.LATC0;
+
+  if (mitActive) {
+    if (lastClock && !clock && (mitBitsSent < 24)) {
+      mitData = (mitFrame >> mitBitsSent) & 1;
+      mitBitsSent++;
+    }
+    else if (!lastClock && clock && (mitBitsSent == 24))
+      mitData = 1;
+    // Done once the firmware has stopped clocking and taken the code.
+    if ((mitBitsSent == 24) && clock && !T2CONbits.TMR2ON)
+      mitActive = FALSE;
+  }
+  lastClock = clock;
+}
+
+static void Interrupt(void)
+{
+  SyncTimers();
+  UserInterrupt();
+  SimStatistics.interrupts++;
+  WatchMIT();
+  Schedule();
+}
+
+static void Loop(void)
+{
+  SyncTimers();
+  UserTasks();
+  SimStatistics.loops++;
+  WatchMIT();
+  Schedule();
+}
+
+/**** Event sources ****/
+
+static void StartMIT(void)
+{
+  mitFrame = mitFrames[mitTail];
+  mitTail = (mitTail + 1) & (N_QUEUED - 1);
+  mitActive = TRUE;
+  mitBitsSent = 0;
+  mitData = 0;                          // Data low starts a code.
+  INTCON3bits.INT2IF = 1;
+  Interrupt();
+}
+
+static void Timer2Match(void)
+{
+  nextTimer2 = now + Timer2Period();
+  PIR1bits.TMR2IF = 1;
+  Interrupt();
+}
+
+static void CCP1Match(void)
+{
+  nextCCP1 = now + CCP1Period();
+  TMR1L = TMR1H = 0;                    // Serviced at once.
+  PIR1bits.CCP1IF = 1;
+  smbxReadIndex = 0;
+  Interrupt();
+  smbxReadIndex = -1;
+}
+
+static void TIByteReceived(void)
+{
+  nextTIByte = NEVER;
+  if (rxCount < sizeof(rxFifo))
+    rxFifo[rxCount++] = tiBytes[tiTail];
+  else
+    RCSTAbits.OERR = 1;
+  tiTail = (tiTail + 1) & (N_QUEUED - 1);
+  PIR1bits.RCIF = 1;
+  if (PIE1bits.RCIE)
+    Interrupt();
+  else
+    Schedule();
+}
+
+// Take a report from the endpoint's next buffer, if the firmware has
+// given it to the SIE.
+static void PollEndpoint(int ep, volatile BDT *even, volatile BDT *odd)
+{
+  volatile BDT *bd = siePPBI[ep - 1] ? odd : even;
+  unsigned char report[64];
+  int i, len;
+
+  if (!bd->Stat.UOWN)
+    return;
+  len = bd->Cnt;
+  for (i = 0; i < len; i++)
+    report[i] = bd->ADR[i];
+  bd->Stat.UOWN = 0;
+  siePPBI[ep - 1] ^= 1;
+
+  SimStatistics.reports[ep - 1]++;
+  // Only inputs the firmware has taken as key events by now.
+  while ((inputTail != inputHead) &&
+         (eventsReported != KeyEventsProcessed)) {
+    eventsReported++;
+    SimTime latency = now - inputTimes[inputTail];
+    inputTail = (inputTail + 1) & (N_QUEUED - 1);
+    SimStatistics.latencies++;
+    SimStatistics.latencyTotal += latency;
+    if (latency > SimStatistics.latencyMax)
+      SimStatistics.latencyMax = latency;
+  }
+  if (reportHandler)
+    (*reportHandler)(now, ep, report, len);
+}
+
+static void Poll(void)
+{
+  nextPoll = now + pollCycles;
+  PollEndpoint(1, &ep1BiE, &ep1BiO);
+  PollEndpoint(2, &ep2BiE, &ep2BiO);
+}
+
+// Run the next event, unless it is later than end.
+static int Step(SimTime end)
+{
+  SimTime next;
+
+  if ((mitHead != mitTail) && !mitActive && INTCON3bits.INT2IE) {
+    StartMIT();
+    return TRUE;
+  }
+
+  next = nextLoop;
+  if (nextTimer2 < next) next = nextTimer2;
+  if (nextCCP1 < next) next = nextCCP1;
+  if (nextTIByte < next) next = nextTIByte;
+  if (nextPoll < next) next = nextPoll;
+  if (next > end) {
+    now = end;
+    return FALSE;
+  }
+  now = next;
+
+  // Interrupts before the main loop at the same time.
+  if (next == nextTimer2)
+    Timer2Match();
+  else if (next == nextCCP1)
+    CCP1Match();
+  else if (next == nextTIByte)
+    TIByteReceived();
+  else if (next == nextPoll)
+    Poll();
+  else {
+    nextLoop = now + loopCycles;
+    Loop();
+  }
+  return TRUE;
+}
+
+static void NoteInput(void)
+{
+  unsigned next = (inputHead + 1) & (N_QUEUED - 1);
+
+  SimStatistics.inputs++;
+  if (next != inputTail) {
+    inputTimes[inputHead] = now;
+    inputHead = next;
+  }
+}
+
+/**** Interface ****/
+
+void SimStart(SimKeyboard keyboard)
+{
+  SimINTCON._byte = SimINTCON2._byte = SimINTCON3._byte = 0;
+  SimPIR1._byte = SimPIE1._byte = 0;
+  SimLATA._byte = SimLATC._byte = SimTRISC._byte = 0;
+  SimT1CON._byte = SimT2CON._byte = SimRCSTA._byte = 0;
+  SimBAUDCON._byte = SimUCON._byte = 0;
+  T0CON = CCP1CON = 0;
+
+  now = 0;
+  memset(&SimStatistics, 0, sizeof(SimStatistics));
+  keyboardSwitches = keyboard;
+  mitHead = mitTail = 0;
+  mitActive = FALSE;
+  mitData = 1;
+  memset(smbxMatrix, 0, sizeof(smbxMatrix));
+  tiHead = tiTail = 0;
+  rxCount = 0;
+  inputHead = inputTail = 0;
+  nextTimer2 = nextCCP1 = nextTIByte = NEVER;
+
+  UserInit();
+  eventsReported = KeyEventsProcessed;
+  lastClock = LATCbits.LATC0;
+
+  // Enumerated and configured at once.
+  usb_active_cfg = 1;
+  usb_device_state = CONFIGURED_STATE;
+  HIDInitEP();
+  idle_rate = 0;                        // As hosts SET_IDLE a keyboard.
+  siePPBI[0] = siePPBI[1] = 0;
+
+  nextLoop = now;
+  nextPoll = now + pollCycles;
+  Schedule();
+}
+
+void SimSetFeature(unsigned char index, unsigned char value)
+{
+  hid_report_feature[index] = value;
+}
+
+void SimSetProtocol(unsigned char protocol)
+{
+  active_protocol = protocol;
+}
+
+void SimSetIdle(unsigned char rate)
+{
+  idle_rate = rate;
+}
+
+void SimSetPollInterval(unsigned ms)
+{
+  pollCycles = SIM_MS(ms ? ms : 1);
+  if (nextPoll != NEVER)
+    nextPoll = now + pollCycles;
+}
+
+void SimSetLoopTime(unsigned us)
+{
+  loopCycles = SIM_US(us ? us : 1);
+}
+
+void SimOnReport(SimReportHandler handler)
+{
+  reportHandler = handler;
+}
+
+void SimQueueMIT(unsigned long frame)
+{
+  mitFrames[mitHead] = frame;
+  mitHead = (mitHead + 1) & (N_QUEUED - 1);
+  NoteInput();
+}
+
+void SimSetSMBXKey(unsigned char code, int down)
+{
+  if (down)
+    smbxMatrix[(code >> 3) & 0x0F] |= (1 << (code & 7));
+  else
+    smbxMatrix[(code >> 3) & 0x0F] &= ~(1 << (code & 7));
+  NoteInput();
+}
+
+void SimQueueTI(unsigned char scan)
+{
+  tiBytes[tiHead] = scan;
+  tiHead = (tiHead + 1) & (N_QUEUED - 1);
+  NoteInput();
+  Schedule();
+}
+
+int SimQuiet(void)
+{
+  return ((mitHead == mitTail) && !mitActive &&
+          (tiHead == tiTail) && (rxCount == 0) &&
+          (memcmp(smbxMatrix, smbxKeyStates, sizeof(smbxMatrix)) == 0) &&
+          (KeyEventIn == KeyEventOut) &&
+          (EmacsBufferedCount == 0) && !KeyReportPending &&
+          !ep1BiE.Stat.UOWN && !ep1BiO.Stat.UOWN &&
+          !ep2BiE.Stat.UOWN && !ep2BiO.Stat.UOWN);
+}
+
+void SimRun(SimTime cycles)
+{
+  SimTime end = now + cycles;
+
+  while (Step(end))
+    ;
+}
+
+SimTime SimRunUntilQuiet(SimTime limit)
+{
+  SimTime start = now;
+
+  while (!SimQuiet() && Step(start + limit))
+    ;
+  return now - start;
+}
+
+SimTime SimNow(void)
+{
+  return now;
+}
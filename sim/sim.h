@@ -0,0 +1,57 @@
+// Host simulation of the firmware: the keyboards, timers, EUSART and
+// the USB host's polling, around the real user.c and hid.c.  Time is
+// counted in instruction cycles at 48MHz.
+
+#ifndef SIM_H
+#define SIM_H
+
+#define SIM_FCY 12000000UL              // Instruction cycles per second.
+#define SIM_MS(ms) ((SimTime)(ms) * (SIM_FCY / 1000))
+#define SIM_US(us) ((SimTime)(us) * (SIM_FCY / 1000000))
+
+typedef unsigned long long SimTime;
+
+// As the keyboard switches (RB<0:1>) select.
+typedef enum {
+  SIM_TK = 0, SIM_SPACE_CADET = 1, SIM_TI = 2, SIM_SMBX = 3
+} SimKeyboard;
+
+// Called for each report the host takes, on endpoint 1 (keyboard) or 2
+// (vendor).
+typedef void (*SimReportHandler)(SimTime when, int ep,
+                                 const unsigned char *report, int len);
+
+typedef struct {
+  unsigned long inputs;                 // Frames, matrix changes, bytes.
+  unsigned long reports[2];             // By endpoint.
+  unsigned long loops;                  // UserTasks passes.
+  unsigned long interrupts;
+  unsigned long latencies;              // Inputs with a report since.
+  SimTime latencyTotal, latencyMax;     // Input to first report after.
+} SimStats;
+
+extern SimStats SimStatistics;
+
+// Reset the device and run UserInit, then enumerate it.
+void SimStart(SimKeyboard keyboard);
+// What the host's SET_REPORT, SET_PROTOCOL and SET_IDLE would store.
+void SimSetFeature(unsigned char index, unsigned char value);
+void SimSetProtocol(unsigned char protocol);
+void SimSetIdle(unsigned char rate);
+void SimSetPollInterval(unsigned ms);
+void SimSetLoopTime(unsigned us);
+void SimOnReport(SimReportHandler handler);
+
+// Keyboard input, from now on.
+void SimQueueMIT(unsigned long frame);
+void SimSetSMBXKey(unsigned char code, int down);
+void SimQueueTI(unsigned char scan);
+
+// Run for so many cycles, or until everything queued has been
+// reported and the device is quiet, but no longer than limit.
+void SimRun(SimTime cycles);
+SimTime SimRunUntilQuiet(SimTime limit);
+int SimQuiet(void);
+SimTime SimNow(void);
+
+#endif //SIM_H
@@ -0,0 +1,13 @@
+// Stand-ins for what hid.c links against in the parts of the USB stack
+// that are not simulated: control transfers are never made, so only
+// the symbols are needed.  usbdsc.c itself relies on C18 accepting an
+// anonymous struct declared twice.
+
+#include "system/typedefs.h"
+
+byte ctrl_trf_session_owner;
+POINTER pSrc, pDst;
+WORD wCount;
+
+byte cfg01[256];
+byte hid_rpt01[256], hid_rpt02[256];
@@ -7,6 +7,8 @@
 #include <p18cxxx.h>
 #include "system/typedefs.h"
 #include "system/interrupt/interrupt.h"
+#include "system/usb/usb.h"
+#include "user/user.h"
 
 /** V A R I A B L E S ********************************************************/
 
@@ -33,11 +35,22 @@ void interrupt_at_low_vector(void)
  * Input:
  * Output:
  * Side Effects:
- * Overview:
+ * Overview:        Services the USB module if USB_INTERRUPT, otherwise
+ *                  the keyboard clock and data lines.
  *****************************************************************************/
-#pragma interrupt high_isr
+#pragma interrupt high_isr save=section(".tmpdata")
 void high_isr(void)
 {
+#if defined(USB_INTERRUPT)
+    if(PIR2bits.USBIF && PIE2bits.USBIE)
+    {
+        if(UCFGbits.UTEYE!=1)
+            USBDriverService();
+        PIR2bits.USBIF = 0;         // Sets again if any UIR flag is left
+    }
+#else
+    UserInterrupt();
+#endif
 }
 
 /******************************************************************************
@@ -46,11 +59,14 @@ void high_isr(void)
  * Input:
  * Output:
  * Side Effects:
- * Overview:
+ * Overview:        Services the keyboard if USB_INTERRUPT.
  *****************************************************************************/
-#pragma interruptlow low_isr
+#pragma interruptlow low_isr save=section(".tmpdata")
 void low_isr(void)
 {
+#if defined(USB_INTERRUPT)
+    UserInterrupt();
+#endif
 }
 #pragma code
 
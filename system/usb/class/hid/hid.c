@@ -47,6 +47,11 @@ byte idle_rate;
 byte active_protocol;               // [0] Boot Protocol [1] Report Protocol
 byte hid_rpt_rx_len;
 byte hid_rpt_ep0_rx_len;
+byte hid_in_ppbi;                   // IN BD the SIE uses next [0] Even [1] Odd
+byte hid_in_len;                    // Of the last report staged, 0 if none
+byte hid_vnd_in_ppbi;
+byte hid_in_dts;                    // Data toggle of the next report
+byte hid_vnd_in_dts;
 
 /** P R I V A T E  P R O T O T Y P E S ***************************************/
 void HIDGetReportHandler(void);
@@ -75,7 +80,8 @@ void HIDSetReportHandler(void);
 void USBCheckHIDRequest(void)
 {
     if(SetupPkt.Recipient != RCPT_INTF) return;
-    if(SetupPkt.bIntfID != HID_INTF_ID) return;
+    if((SetupPkt.bIntfID != HID_INTF_ID) &&
+       (SetupPkt.bIntfID != HID_VND_INTF_ID)) return;
     
     /*
      * There are two standard requests that hid.c may support.
@@ -120,7 +126,10 @@ void USBCheckHIDRequest(void)
             break;
         case SET_IDLE:
             ctrl_trf_session_owner = MUID_HID;
-            idle_rate = MSB(SetupPkt.W_Value);
+            // The vendor interface's reports are events, not state, so
+            // are never repeated.
+            if(SetupPkt.bIntfID == HID_INTF_ID)
+                idle_rate = MSB(SetupPkt.W_Value);
             break;
         case GET_PROTOCOL:
             ctrl_trf_session_owner = MUID_HID;
@@ -138,10 +147,27 @@ void USBCheckHIDRequest(void)
 
 void HIDGetReportHandler(void)
 {
-  if (SetupPkt.wValue == (((word)RPT_INPUT << 8) | 0)) {
+  if (SetupPkt.bIntfID == HID_VND_INTF_ID) {
+    if (SetupPkt.wValue == (((word)RPT_INPUT << 8) | HID_VND_KEYSYM_RPT_ID)) {
+      ctrl_trf_session_owner = MUID_HID;
+      pSrc.bRam = (byte*)&hid_vnd_report_in[hid_vnd_in_ppbi ^ 1]; // Last sent
+      wCount._word = HID_VND_KEYSYM_RPT_SIZE;
+      usb_stat.ctrl_trf_mem = _RAM;
+    }
+    else if (SetupPkt.wValue == (((word)RPT_FEATURE << 8) | HID_VND_PERF_RPT_ID)) {
+      ctrl_trf_session_owner = MUID_HID;
+      pSrc.bRam = (byte*)&hid_vnd_report_feature;
+      wCount._word = HID_VND_FEATURE_SIZE;
+      usb_stat.ctrl_trf_mem = _RAM;
+    }
+  }
+  else if (SetupPkt.wValue == (((word)RPT_INPUT << 8) | 0)) {
     ctrl_trf_session_owner = MUID_HID;
-    pSrc.bRam = (byte*)&hid_report_in;
-    wCount._word = HID_INT_IN_EP_SIZE;
+    pSrc.bRam = (byte*)&hid_report_in[hid_in_ppbi ^ 1]; // Last sent
+    if (active_protocol == BOOT_PROTOCOL)
+      wCount._word = HID_BOOT_RPT_SIZE;
+    else
+      wCount._word = HID_INT_IN_EP_SIZE;
     usb_stat.ctrl_trf_mem = _RAM;
   }
   else if (SetupPkt.wValue == (((word)RPT_FEATURE << 8) | 0)) {
@@ -154,6 +180,9 @@ void HIDGetReportHandler(void)
 
 void HIDSetReportHandler(void)
 {
+  if (SetupPkt.bIntfID != HID_INTF_ID)
+    return;                     // Vendor interface has no output.
+
   if (SetupPkt.wValue == (((word)RPT_OUTPUT << 8) | 0)) {
     if (wCount._word >= SetupPkt.wLength) {
       // Arrange for HIDRxReport to pick it up.
@@ -165,7 +194,7 @@ void HIDSetReportHandler(void)
 
     if (ctrl_trf_session_owner != MUID_HID) {
       ctrl_trf_session_owner = MUID_HID;
-      pDst.bRam = (byte*)&hid_report_out; // Need a separate buffer from EP1?
+      pDst.bRam = (byte*)&hid_report_out;
     }
   }
   else if (SetupPkt.wValue == (((word)RPT_FEATURE << 8) | 0)) {
@@ -199,12 +228,14 @@ void HIDInitEP(void)
 {   
     hid_rpt_rx_len =0;
     hid_rpt_ep0_rx_len = 0;
+    active_protocol = RPT_PROTOCOL;             // Default after configuration
+    idle_rate = HID_IDLE_DEFAULT;               // Until the host sets it
     
-    HID_UEP = EP_OUT_IN|HSHK_EN;                // Enable 2 data pipes
-    
-    HID_BD_OUT.Cnt = sizeof(hid_report_out);    // Set buffer size
-    HID_BD_OUT.ADR = (byte*)&hid_report_out;    // Set buffer address
-    HID_BD_OUT.Stat._byte = _USIE|_DAT0|_DTSEN; // Set status
+    /*
+     * No interrupt OUT endpoint: the LED report comes by SET_REPORT on
+     * EP0.  Enabling EP1 OUT would also ping-pong it, needing both BDs.
+     */
+    HID_UEP = EP_IN|HSHK_EN;                    // IN only
 
     /*
      * Do not have to init Cnt of IN pipes here.
@@ -217,11 +248,104 @@ void HIDInitEP(void)
      *          be known right before the data is
      *          sent.
      */
-    HID_BD_IN.ADR = (byte*)&hid_report_in;      // Set buffer address
-    HID_BD_IN.Stat._byte = _UCPU|_DAT1;         // Set status
+    HID_VND_UEP = EP_IN|HSHK_EN;                // Vendor interface IN only
+
+    HIDResetInEP();
 
 }//end HIDInitEP
 
+/******************************************************************************
+ * Function:        void HIDResetInEP(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Any report staged on either IN endpoint is dropped.
+ *
+ * Overview:        Takes back both BDs of both IN endpoints, ready for
+ *                  DATA0, and points the SIE and HIDTxReport at the even
+ *                  ones.  For configuration.
+ *
+ * Note:            PPBRST resets every endpoint's ping-pong pointer, so
+ *                  both IN endpoints are reset together.  The keyboard
+ *                  report is sent again even if unchanged.
+ *****************************************************************************/
+void HIDResetInEP(void)
+{
+    /*
+     * The IN endpoints are ping-pong buffered, so that a report can be
+     * staged while the SIE still owns the other buffer.  Reports
+     * alternate between the two BDs, but the data toggle is kept apart,
+     * since clearing a halt starts it over at DATA0 on either BD.
+     */
+    HID_BD_IN_EVEN.ADR = (byte*)&hid_report_in[0];
+    HID_BD_IN_EVEN.Stat._byte = _UCPU|_DAT0;
+    HID_BD_IN_ODD.ADR = (byte*)&hid_report_in[1];
+    HID_BD_IN_ODD.Stat._byte = _UCPU|_DAT1;
+
+    HID_VND_BD_IN_EVEN.ADR = (byte*)&hid_vnd_report_in[0];
+    HID_VND_BD_IN_EVEN.Stat._byte = _UCPU|_DAT0;
+    HID_VND_BD_IN_ODD.ADR = (byte*)&hid_vnd_report_in[1];
+    HID_VND_BD_IN_ODD.Stat._byte = _UCPU|_DAT1;
+
+    hid_in_ppbi = 0;                            // Match the SIE's pointers
+    hid_vnd_in_ppbi = 0;
+    hid_in_len = 0;
+    hid_in_dts = _DAT0;
+    hid_vnd_in_dts = _DAT0;
+    UCONbits.PPBRST = 1;
+    UCONbits.PPBRST = 0;
+
+}//end HIDResetInEP
+
+/******************************************************************************
+ * Function:        void HIDHaltInEP(byte ep, BOOL halt)
+ *
+ * PreCondition:    None
+ *
+ * Input:           ep      : Endpoint number, HID_EP or HID_VND_EP
+ *                  halt    : TRUE for SET_FEATURE, FALSE for CLEAR_FEATURE
+ *
+ * Output:          None
+ *
+ * Side Effects:    Any report staged on that endpoint is dropped.
+ *
+ * Overview:        Called through mUSBHaltInEP by usb9.c, just before it
+ *                  stalls or releases both of the endpoint's BDs.  Points
+ *                  HIDTxReport back at the BD the SIE will use next and,
+ *                  when the halt is cleared, starts the toggle over.
+ *
+ * Note:            The SIE's pointer only moves when a transaction
+ *                  completes, so it is at the oldest BD the SIE still
+ *                  owns, if any.  A stalled pair is owned in full and so
+ *                  leaves the index alone.  PPBRST cannot be used here,
+ *                  since it would also move the other endpoints.
+ *****************************************************************************/
+void HIDHaltInEP(byte ep, BOOL halt)
+{
+    if (ep == HID_EP)
+    {
+        if (hid_in_ppbi ? (HID_BD_IN_EVEN.Stat.UOWN && !HID_BD_IN_ODD.Stat.UOWN) :
+                          (HID_BD_IN_ODD.Stat.UOWN && !HID_BD_IN_EVEN.Stat.UOWN))
+            hid_in_ppbi ^= 1;
+        hid_in_len = 0;
+        if (!halt)
+            hid_in_dts = _DAT0;
+    }
+    else if (ep == HID_VND_EP)
+    {
+        if (hid_vnd_in_ppbi ? (HID_VND_BD_IN_EVEN.Stat.UOWN && !HID_VND_BD_IN_ODD.Stat.UOWN) :
+                              (HID_VND_BD_IN_ODD.Stat.UOWN && !HID_VND_BD_IN_EVEN.Stat.UOWN))
+            hid_vnd_in_ppbi ^= 1;
+        if (!halt)
+            hid_vnd_in_dts = _DAT0;
+    }
+
+}//end HIDHaltInEP
+
 /******************************************************************************
  * Function:        void HIDTxReport(char *buffer, byte len)
  *
@@ -267,13 +391,105 @@ void HIDTxReport(char *buffer, byte len)
     * Copy data from user's buffer to dual-ram buffer
     */
     for (i = 0; i < len; i++)
-    	hid_report_in[i] = buffer[i];
+    	hid_report_in[hid_in_ppbi][i] = buffer[i];
 
-    HID_BD_IN.Cnt = len;
-    mUSBBufferReady(HID_BD_IN);
+    /*
+     * Hand the staged buffer to the SIE; see HIDResetInEP for the toggle.
+     */
+    if (hid_in_ppbi)
+    {
+        HID_BD_IN_ODD.Cnt = len;
+        HID_BD_IN_ODD.Stat._byte = _USIE|hid_in_dts|_DTSEN;
+    }
+    else
+    {
+        HID_BD_IN_EVEN.Cnt = len;
+        HID_BD_IN_EVEN.Stat._byte = _USIE|hid_in_dts|_DTSEN;
+    }
+    hid_in_ppbi ^= 1;
+    hid_in_dts ^= _DTSMASK;
+    hid_in_len = len;
 
 }//end HIDTxReport
 
+/******************************************************************************
+ * Function:        BOOL HIDTxIsSameReport(char *buffer, byte len, byte cmp)
+ *
+ * PreCondition:    None
+ *
+ * Input:           buffer  : Pointer to the starting location of data bytes
+ *                  len     : Number of bytes that would be transferred
+ *                  cmp     : Number of those bytes to compare
+ *
+ * Output:          TRUE if the last report given to HIDTxReport had the
+ *                  same length and the same first cmp bytes
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Use this to leave out a report that would tell the host
+ *                  nothing new.  Bytes past cmp, such as a timestamp, are
+ *                  not compared.
+ *
+ * Note:            The last report is still in its BD's buffer, whether or
+ *                  not the SIE has sent it yet.
+ *****************************************************************************/
+BOOL HIDTxIsSameReport(char *buffer, byte len, byte cmp)
+{
+    byte i, last;
+
+    if((hid_in_len == 0) || (len != hid_in_len))
+        return FALSE;
+    last = hid_in_ppbi ^ 1;
+    for (i = 0; i < cmp; i++)
+    {
+        if(hid_report_in[last][i] != buffer[i])
+            return FALSE;
+    }
+    return TRUE;
+
+}//end HIDTxIsSameReport
+
+/******************************************************************************
+ * Function:        void HIDVndTxReport(char *buffer, byte len)
+ *
+ * PreCondition:    mHIDVndTxIsBusy() must return false.
+ *
+ * Input:           buffer  : Pointer to the report, starting with its ID
+ *                  len     : Number of bytes to be transferred
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        As HIDTxReport, but on the vendor interface's IN endpoint.
+ *
+ * Note:            None
+ *****************************************************************************/
+void HIDVndTxReport(char *buffer, byte len)
+{
+    byte i;
+
+    if(len > HID_VND_INT_IN_EP_SIZE)
+        len = HID_VND_INT_IN_EP_SIZE;
+
+    for (i = 0; i < len; i++)
+        hid_vnd_report_in[hid_vnd_in_ppbi][i] = buffer[i];
+
+    if (hid_vnd_in_ppbi)
+    {
+        HID_VND_BD_IN_ODD.Cnt = len;
+        HID_VND_BD_IN_ODD.Stat._byte = _USIE|hid_vnd_in_dts|_DTSEN;
+    }
+    else
+    {
+        HID_VND_BD_IN_EVEN.Cnt = len;
+        HID_VND_BD_IN_EVEN.Stat._byte = _USIE|hid_vnd_in_dts|_DTSEN;
+    }
+    hid_vnd_in_ppbi ^= 1;
+    hid_vnd_in_dts ^= _DTSMASK;
+
+}//end HIDVndTxReport
+
 /******************************************************************************
  * Function:        byte HIDRxReport(char *buffer, byte len)
  *
@@ -295,7 +511,7 @@ void HIDTxReport(char *buffer, byte len)
  *                  mHIDGetRptRxLength().
  *
  * Overview:        HIDRxReport copies a string of bytes received through
- *                  USB HID OUT endpoint to a user's specified location. 
+ *                  SET_REPORT on EP0 to a user's specified location. 
  *                  It is a non-blocking function. It does not wait
  *                  for data if there is no data available. Instead it returns
  *                  '0' to notify the caller that there is no data available.
@@ -320,27 +536,6 @@ byte HIDRxReport(char *buffer, byte len)
 
         hid_rpt_ep0_rx_len = 0;
     }
-    else if(!mHIDRxIsBusy())
-    {
-        /*
-         * Adjust the expected number of bytes to equal
-         * the actual number of bytes received.
-         */
-        if(len > HID_BD_OUT.Cnt)
-            len = HID_BD_OUT.Cnt;
-        
-        /*
-         * Copy data from dual-ram buffer to user's buffer
-         */
-        for(hid_rpt_rx_len = 0; hid_rpt_rx_len < len; hid_rpt_rx_len++)
-            buffer[hid_rpt_rx_len] = hid_report_out[hid_rpt_rx_len];
-
-        /*
-         * Prepare dual-ram buffer for next OUT transaction
-         */
-        HID_BD_OUT.Cnt = sizeof(hid_report_out);
-        mUSBBufferReady(HID_BD_OUT);
-    }//end if
     
     return hid_rpt_rx_len;
     
@@ -58,6 +58,19 @@
 #define BOOT_PROTOCOL   0x00
 #define RPT_PROTOCOL    0x01
 
+/* Boot Protocol Keyboard Input Report Size */
+#define HID_BOOT_RPT_SIZE   8
+
+/* Vendor Interface Keysym Input Report, including its ID */
+#define HID_VND_KEYSYM_RPT_ID   0x01
+#define HID_VND_KEYSYM_RPT_SIZE 4
+
+/* Vendor Interface Performance Counters Feature Report, including its ID */
+#define HID_VND_PERF_RPT_ID     0x02
+
+/* Idle rate after configuration, in 4 ms units: 500 ms for keyboards */
+#define HID_IDLE_DEFAULT    125
+
 /* Report Types */
 #define RPT_INPUT       0x01
 #define RPT_OUTPUT      0x02
@@ -75,7 +88,7 @@
 #define HID_PROTOCOL_MOUSE          0x02
 
 /******************************************************************************
- * Macro:           (bit) mHIDRxIsBusy(void)
+ * Macro:           (bit) mHIDTxIsBusy(void)
  *
  * PreCondition:    None
  *
@@ -85,16 +98,19 @@
  *
  * Side Effects:    None
  *
- * Overview:        This macro is used to check if HID OUT endpoint is
+ * Overview:        This macro is used to check if HID IN endpoint is
  *                  busy (owned by SIE) or not.
- *                  Typical Usage: if(mHIDRxIsBusy())
+ *                  Typical Usage: if(mHIDTxIsBusy())
  *
- * Note:            None
+ * Note:            The endpoint is ping-pong buffered, so this only checks
+ *                  the BD that the next report would go into. One report
+ *                  can be staged while another is still in flight.
  *****************************************************************************/
-#define mHIDRxIsBusy()              HID_BD_OUT.Stat.UOWN
+#define mHIDTxIsBusy()              (hid_in_ppbi ? HID_BD_IN_ODD.Stat.UOWN : \
+                                                   HID_BD_IN_EVEN.Stat.UOWN)
 
 /******************************************************************************
- * Macro:           (bit) mHIDTxIsBusy(void)
+ * Macro:           (bit) mHIDVndTxIsBusy(void)
  *
  * PreCondition:    None
  *
@@ -104,13 +120,15 @@
  *
  * Side Effects:    None
  *
- * Overview:        This macro is used to check if HID IN endpoint is
- *                  busy (owned by SIE) or not.
- *                  Typical Usage: if(mHIDTxIsBusy())
+ * Overview:        This macro is used to check if the vendor interface's
+ *                  IN endpoint is busy (owned by SIE) or not.
+ *                  Typical Usage: if(mHIDVndTxIsBusy())
  *
- * Note:            None
+ * Note:            Ping-pong buffered, as for mHIDTxIsBusy.
  *****************************************************************************/
-#define mHIDTxIsBusy()              HID_BD_IN.Stat.UOWN
+#define mHIDVndTxIsBusy()           (hid_vnd_in_ppbi ? \
+                                     HID_VND_BD_IN_ODD.Stat.UOWN : \
+                                     HID_VND_BD_IN_EVEN.Stat.UOWN)
 
 /******************************************************************************
  * Macro:           byte mHIDGetRptRxLength(void)
@@ -149,12 +167,20 @@ typedef struct _USB_HID_DSC
 } USB_HID_DSC;
 
 /** E X T E R N S ************************************************************/
+extern byte idle_rate;
 extern byte hid_rpt_rx_len;
+extern byte hid_in_ppbi;
+extern byte hid_vnd_in_ppbi;
+extern byte active_protocol;
 
 /** P U B L I C  P R O T O T Y P E S *****************************************/
 void HIDInitEP(void);
+void HIDResetInEP(void);
+void HIDHaltInEP(byte ep, BOOL halt);
 void USBCheckHIDRequest(void);
 void HIDTxReport(char *buffer, byte len);
+BOOL HIDTxIsSameReport(char *buffer, byte len, byte cmp);
+void HIDVndTxReport(char *buffer, byte len);
 byte HIDRxReport(char *buffer, byte len);
 
 #endif //HID_H
@@ -49,6 +49,15 @@ void USBStdSetCfgHandler(void);
 void USBStdGetStatusHandler(void);
 void USBStdFeatureReqHandler(void);
 
+/*
+ * Address of the BD for an endpoint and direction.  With MODE_PP _PPBM3,
+ * EP0 has one BD each way and every other endpoint an even and odd pair
+ * each way; this gives the even one of the pair.  See usbmmap.c.
+ */
+#define mUSBEPBDAdr(ep,dir) ((ep) == 0 ? \
+                             (byte*)&ep0Bo+((dir)*4) : \
+                             (byte*)&ep0Bo+((ep)*16)+((dir)*8)-8)
+
 /** D E C L A R A T I O N S **************************************************/
 #pragma code
 /******************************************************************************
@@ -242,7 +251,7 @@ void USBStdGetStatusHandler(void)
             /*
              * _byte0: bit0: Halt Status [0] Not Halted [1] Halted
              */
-            pDst.bRam = (byte*)&ep0Bo+(SetupPkt.EPNum*8)+(SetupPkt.EPDir*4);
+            pDst.bRam = mUSBEPBDAdr(SetupPkt.EPNum,SetupPkt.EPDir);
             if(*pDst.bRam & _BSTALL)    // Use _BSTALL as a bit mask
                 CtrlTrfData._byte0=0x01;// Set bit0
             break;
@@ -290,16 +299,36 @@ void USBStdFeatureReqHandler(void)
     {
         ctrl_trf_session_owner = MUID_USB9;
         /* Must do address calculation here */
-        pDst.bRam = (byte*)&ep0Bo+(SetupPkt.EPNum*8)+(SetupPkt.EPDir*4);
+        pDst.bRam = mUSBEPBDAdr(SetupPkt.EPNum,SetupPkt.EPDir);
         
+        /*
+         * Either BD of the ping-pong pair may be the next one the SIE
+         * uses, so stall or release both.  No OUT endpoint other than
+         * EP0 is enabled; one that was would need a buffer on its odd BD
+         * as well as the even one.  The class is told first, so that
+         * it can follow the SIE's pointer and the data toggle.
+         */
+#if defined(mUSBHaltInEP)
+        if(SetupPkt.EPDir == 1)
+            mUSBHaltInEP(SetupPkt.EPNum,SetupPkt.bRequest == SET_FEATURE);
+#endif
         if(SetupPkt.bRequest == SET_FEATURE)
+        {
             *pDst.bRam = _USIE|_BSTALL;
+            *(pDst.bRam+4) = _USIE|_BSTALL;
+        }
         else
         {
             if(SetupPkt.EPDir == 1) // IN
-                *pDst.bRam = _UCPU;
+            {
+                *pDst.bRam = _UCPU|_DAT0;
+                *(pDst.bRam+4) = _UCPU|_DAT1;
+            }
             else
+            {
                 *pDst.bRam = _USIE|_DAT0|_DTSEN;
+                *(pDst.bRam+4) = _UCPU|_DAT1;
+            }
         }//end if
     }//end if
 }//end USBStdFeatureReqHandler
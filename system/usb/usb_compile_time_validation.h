@@ -48,6 +48,10 @@
 #error(Invalid buffer size for endpoint 0,check "autofiles\usbcfg.h")
 #endif
 
+#if (MODE_PP != _PPBM3)
+#error(The BDT layout in usbmmap.c needs ping-pong mode 3, check "autofiles\usbcfg.h")
+#endif
+
 #if defined(HID_INT_OUT_EP_SIZE)
     #if (HID_INT_OUT_EP_SIZE > 64)
         #error(HID Out endpoint size cannot be bigger than 64, check "autofiles\usbcfg.h")
@@ -60,4 +64,31 @@
     #endif
 #endif
 
+#if ((UCFG_VAL & _FS) == 0)
+    #if (EP0_BUFF_SIZE != 8)
+        #error(Low speed endpoint 0 must be 8 bytes, check "autofiles\usbcfg.h")
+    #endif
+    #if defined(HID_INT_IN_EP_SIZE)
+        #if (HID_INT_IN_EP_SIZE > 8)
+            #error(Low speed HID In endpoint cannot be bigger than 8, check "autofiles\usbcfg.h")
+        #endif
+    #endif
+    #if defined(HID_VND_INT_IN_EP_SIZE)
+        #if (HID_VND_INT_IN_EP_SIZE > 8)
+            #error(Low speed vendor HID In endpoint cannot be bigger than 8, check "autofiles\usbcfg.h")
+        #endif
+    #endif
+    #if defined(HID_INT_IN_INTERVAL)
+        #if (HID_INT_IN_INTERVAL < 10)
+            #error(Low speed HID In interval must be at least 10 ms, check "autofiles\usbcfg.h")
+        #endif
+    #endif
+#endif
+
+#if defined(HID_INT_IN_INTERVAL)
+    #if (HID_INT_IN_INTERVAL < 1) || (HID_INT_IN_INTERVAL > 255)
+        #error(HID In interval must be 1 to 255 ms, check "autofiles\usbcfg.h")
+    #endif
+#endif
+
 #endif //USB_COMPILE_TIME_VALIDATION_H
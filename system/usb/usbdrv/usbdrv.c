@@ -301,6 +301,8 @@ void USBDriverService(void)
  *****************************************************************************/
 void USBSuspend(void)
 {
+    byte gie;
+
     /*
      * NOTE: Do not clear UIRbits.ACTVIF here!
      * Reason:
@@ -334,6 +336,8 @@ void USBSuspend(void)
      */
     
     /* Modifiable Section */
+    gie = INTCONbits.GIE;                   // Wake sources are not serviced
+    INTCONbits.GIE = 0;                     // by the keyboard interrupt
     PIR2bits.USBIF = 0;
     INTCONbits.RBIF = 0;
     PIE2bits.USBIE = 1;                     // Set USB wakeup source
@@ -344,8 +348,11 @@ void USBSuspend(void)
     {
         USBRemoteWakeup();                  // If yes, attempt RWU
     }
-    PIE2bits.USBIE = 0;
+#if !defined(USB_INTERRUPT)
+    PIE2bits.USBIE = 0;                     // Else needed to service USB
+#endif
     INTCONbits.RBIE = 0;
+    INTCONbits.GIE = gie;
     /* End Modifiable Section */
 
 }//end USBSuspend
@@ -576,6 +583,8 @@ void USBProtocolResetHandler(void)
         UIRbits.TRNIF = 0;
 
     UCONbits.PKTDIS = 0;            // Make sure packet processing is enabled
+    UCONbits.PPBRST = 1;            // Point all ping-pong pairs at even
+    UCONbits.PPBRST = 0;
     USBPrepareForNextSetupTrf();    // Declared in usbctrltrf.c
     
     usb_stat.RemoteWakeup = 0;      // Default status flag to disable
@@ -47,6 +47,7 @@
 #define _PPBM0      0x00            // Pingpong Buffer Mode 0
 #define _PPBM1      0x01            // Pingpong Buffer Mode 1
 #define _PPBM2      0x02            // Pingpong Buffer Mode 2
+#define _PPBM3      0x03            // Pingpong Buffer Mode 3, all but EP0
 #define _LS         0x00            // Use Low-Speed USB Mode
 #define _FS         0x04            // Use Full-Speed USB Mode
 #define _TRINT      0x00            // Use internal transceiver
@@ -172,7 +173,7 @@
  * Input:           byte buffer_dsc: Root name of the buffer descriptor group.
  *                  i.e. ep0Bo, ep1Bi, ... Declared in usbmmap.c
  *                  Names can be remapped for readability, see examples in
- *                  usbcfg.h (#define HID_BD_OUT      ep1Bo)
+ *                  usbcfg.h (#define HID_BD_OUT      ep1BoE)
  *
  * Output:          None
  *
@@ -97,7 +97,7 @@
  * USB interface function:
  * 1. The USB interface ID
  * 2. The endpoint control registers (UEPn)
- * 3. The BDT registers (ep<#>B<d>)
+ * 3. The BDT registers (ep<#>B<d><p>, p being E(ven) or O(dd))
  * 4. The endpoint size
  *
  * Example: Assume a USB device class "foo", which uses one out endpoint
@@ -105,14 +105,14 @@
  *
  * #define FOO_INTF_ID          0x00
  * #define FOO_UEP              UEP1
- * #define FOO_BD_OUT           ep1Bo
- * #define FOO_BD_IN            ep1Bi
+ * #define FOO_BD_OUT           ep1BoE
+ * #define FOO_BD_IN            ep1BiE
  * #define FOO_EP_SIZE          64
  *
  * The mapping above has chosen class "foo" to use endpoint 1.
  * The names are arbitrary and can be anything other than FOO_??????.
  * For abstraction, the code for class "foo" should use the abstract
- * definitions of FOO_BD_OUT,FOO_BD_IN, and not ep1Bo or ep1Bi.
+ * definitions of FOO_BD_OUT,FOO_BD_IN, and not ep1BoE or ep1BiE.
  *
  * Note that the endpoint size defined in the usbcfg.h file is again
  * used in the usbmmap.c file. This shows that the relationship between
@@ -168,6 +168,8 @@ byte usb_alt_intf[MAX_NUM_INT]; // Array to keep track of the current alternate
  * - 0x400 - 0x4FF(max)
  * - MAX_EP_NUMBER is defined in autofiles\usbcfg.h
  * - BDT data type is defined in system\usb\usbmmap.h
+ * - Laid out for MODE_PP _PPBM3: EP0 has a single BD each way, every
+ *   other endpoint has an even and an odd BD each way.
  *****************************************************************************/
 
 #if(0 <= MAX_EP_NUMBER)
@@ -176,78 +178,108 @@ volatile far BDT ep0Bi;         //Endpoint #0 BD In
 #endif
 
 #if(1 <= MAX_EP_NUMBER)
-volatile far BDT ep1Bo;         //Endpoint #1 BD Out
-volatile far BDT ep1Bi;         //Endpoint #1 BD In
+volatile far BDT ep1BoE;        //Endpoint #1 BD Out Even
+volatile far BDT ep1BoO;        //Endpoint #1 BD Out Odd
+volatile far BDT ep1BiE;        //Endpoint #1 BD In Even
+volatile far BDT ep1BiO;        //Endpoint #1 BD In Odd
 #endif
 
 #if(2 <= MAX_EP_NUMBER)
-volatile far BDT ep2Bo;         //Endpoint #2 BD Out
-volatile far BDT ep2Bi;         //Endpoint #2 BD In
+volatile far BDT ep2BoE;        //Endpoint #2 BD Out Even
+volatile far BDT ep2BoO;        //Endpoint #2 BD Out Odd
+volatile far BDT ep2BiE;        //Endpoint #2 BD In Even
+volatile far BDT ep2BiO;        //Endpoint #2 BD In Odd
 #endif
 
 #if(3 <= MAX_EP_NUMBER)
-volatile far BDT ep3Bo;         //Endpoint #3 BD Out
-volatile far BDT ep3Bi;         //Endpoint #3 BD In
+volatile far BDT ep3BoE;        //Endpoint #3 BD Out Even
+volatile far BDT ep3BoO;        //Endpoint #3 BD Out Odd
+volatile far BDT ep3BiE;        //Endpoint #3 BD In Even
+volatile far BDT ep3BiO;        //Endpoint #3 BD In Odd
 #endif
 
 #if(4 <= MAX_EP_NUMBER)
-volatile far BDT ep4Bo;         //Endpoint #4 BD Out
-volatile far BDT ep4Bi;         //Endpoint #4 BD In
+volatile far BDT ep4BoE;        //Endpoint #4 BD Out Even
+volatile far BDT ep4BoO;        //Endpoint #4 BD Out Odd
+volatile far BDT ep4BiE;        //Endpoint #4 BD In Even
+volatile far BDT ep4BiO;        //Endpoint #4 BD In Odd
 #endif
 
 #if(5 <= MAX_EP_NUMBER)
-volatile far BDT ep5Bo;         //Endpoint #5 BD Out
-volatile far BDT ep5Bi;         //Endpoint #5 BD In
+volatile far BDT ep5BoE;        //Endpoint #5 BD Out Even
+volatile far BDT ep5BoO;        //Endpoint #5 BD Out Odd
+volatile far BDT ep5BiE;        //Endpoint #5 BD In Even
+volatile far BDT ep5BiO;        //Endpoint #5 BD In Odd
 #endif
 
 #if(6 <= MAX_EP_NUMBER)
-volatile far BDT ep6Bo;         //Endpoint #6 BD Out
-volatile far BDT ep6Bi;         //Endpoint #6 BD In
+volatile far BDT ep6BoE;        //Endpoint #6 BD Out Even
+volatile far BDT ep6BoO;        //Endpoint #6 BD Out Odd
+volatile far BDT ep6BiE;        //Endpoint #6 BD In Even
+volatile far BDT ep6BiO;        //Endpoint #6 BD In Odd
 #endif
 
 #if(7 <= MAX_EP_NUMBER)
-volatile far BDT ep7Bo;         //Endpoint #7 BD Out
-volatile far BDT ep7Bi;         //Endpoint #7 BD In
+volatile far BDT ep7BoE;        //Endpoint #7 BD Out Even
+volatile far BDT ep7BoO;        //Endpoint #7 BD Out Odd
+volatile far BDT ep7BiE;        //Endpoint #7 BD In Even
+volatile far BDT ep7BiO;        //Endpoint #7 BD In Odd
 #endif
 
 #if(8 <= MAX_EP_NUMBER)
-volatile far BDT ep8Bo;         //Endpoint #8 BD Out
-volatile far BDT ep8Bi;         //Endpoint #8 BD In
+volatile far BDT ep8BoE;        //Endpoint #8 BD Out Even
+volatile far BDT ep8BoO;        //Endpoint #8 BD Out Odd
+volatile far BDT ep8BiE;        //Endpoint #8 BD In Even
+volatile far BDT ep8BiO;        //Endpoint #8 BD In Odd
 #endif
 
 #if(9 <= MAX_EP_NUMBER)
-volatile far BDT ep9Bo;         //Endpoint #9 BD Out
-volatile far BDT ep9Bi;         //Endpoint #9 BD In
+volatile far BDT ep9BoE;        //Endpoint #9 BD Out Even
+volatile far BDT ep9BoO;        //Endpoint #9 BD Out Odd
+volatile far BDT ep9BiE;        //Endpoint #9 BD In Even
+volatile far BDT ep9BiO;        //Endpoint #9 BD In Odd
 #endif
 
 #if(10 <= MAX_EP_NUMBER)
-volatile far BDT ep10Bo;        //Endpoint #10 BD Out
-volatile far BDT ep10Bi;        //Endpoint #10 BD In
+volatile far BDT ep10BoE;       //Endpoint #10 BD Out Even
+volatile far BDT ep10BoO;       //Endpoint #10 BD Out Odd
+volatile far BDT ep10BiE;       //Endpoint #10 BD In Even
+volatile far BDT ep10BiO;       //Endpoint #10 BD In Odd
 #endif
 
 #if(11 <= MAX_EP_NUMBER)
-volatile far BDT ep11Bo;        //Endpoint #11 BD Out
-volatile far BDT ep11Bi;        //Endpoint #11 BD In
+volatile far BDT ep11BoE;       //Endpoint #11 BD Out Even
+volatile far BDT ep11BoO;       //Endpoint #11 BD Out Odd
+volatile far BDT ep11BiE;       //Endpoint #11 BD In Even
+volatile far BDT ep11BiO;       //Endpoint #11 BD In Odd
 #endif
 
 #if(12 <= MAX_EP_NUMBER)
-volatile far BDT ep12Bo;        //Endpoint #12 BD Out
-volatile far BDT ep12Bi;        //Endpoint #12 BD In
+volatile far BDT ep12BoE;       //Endpoint #12 BD Out Even
+volatile far BDT ep12BoO;       //Endpoint #12 BD Out Odd
+volatile far BDT ep12BiE;       //Endpoint #12 BD In Even
+volatile far BDT ep12BiO;       //Endpoint #12 BD In Odd
 #endif
 
 #if(13 <= MAX_EP_NUMBER)
-volatile far BDT ep13Bo;        //Endpoint #13 BD Out
-volatile far BDT ep13Bi;        //Endpoint #13 BD In
+volatile far BDT ep13BoE;       //Endpoint #13 BD Out Even
+volatile far BDT ep13BoO;       //Endpoint #13 BD Out Odd
+volatile far BDT ep13BiE;       //Endpoint #13 BD In Even
+volatile far BDT ep13BiO;       //Endpoint #13 BD In Odd
 #endif
 
 #if(14 <= MAX_EP_NUMBER)
-volatile far BDT ep14Bo;        //Endpoint #14 BD Out
-volatile far BDT ep14Bi;        //Endpoint #14 BD In
+volatile far BDT ep14BoE;       //Endpoint #14 BD Out Even
+volatile far BDT ep14BoO;       //Endpoint #14 BD Out Odd
+volatile far BDT ep14BiE;       //Endpoint #14 BD In Even
+volatile far BDT ep14BiO;       //Endpoint #14 BD In Odd
 #endif
 
 #if(15 <= MAX_EP_NUMBER)
-volatile far BDT ep15Bo;        //Endpoint #15 BD Out
-volatile far BDT ep15Bi;        //Endpoint #15 BD In
+volatile far BDT ep15BoE;       //Endpoint #15 BD Out Even
+volatile far BDT ep15BoO;       //Endpoint #15 BD Out Odd
+volatile far BDT ep15BiE;       //Endpoint #15 BD In Even
+volatile far BDT ep15BiO;       //Endpoint #15 BD In Odd
 #endif
 
 /******************************************************************************
@@ -271,12 +303,17 @@ volatile far CTRL_TRF_DATA CtrlTrfData;
 /******************************************************************************
  * Section C: HID Buffer
  ******************************************************************************
- *
+ * - The IN reports have one buffer for each of the even and odd BDs.
+ * - Kept in the next bank, since with full speed and the N-key rollover
+ *   report they no longer fit after the BDT.
  *****************************************************************************/
+#pragma udata usbram5=0x500     //See Linker Script,usb5:0x500-0x5FF(256-byte)
 #if defined(USB_USE_HID)
 volatile far unsigned char hid_report_out[HID_INT_OUT_EP_SIZE];
-volatile far unsigned char hid_report_in[HID_INT_IN_EP_SIZE];
+volatile far unsigned char hid_report_in[2][HID_INT_IN_EP_SIZE];
 volatile far unsigned char hid_report_feature[HID_FEATURE_SIZE];
+volatile far unsigned char hid_vnd_report_in[2][HID_VND_INT_IN_EP_SIZE];
+volatile far unsigned char hid_vnd_report_feature[HID_VND_FEATURE_SIZE];
 #endif
 
 #pragma udata
@@ -91,14 +91,12 @@ typedef union _BD_STAT
         unsigned UOWN:1;                //USB Ownership
     };
     struct{
-        unsigned BC8:1;
-        unsigned BC9:1;
+        unsigned :2;                    //BC8, BC9 (unnamed, for gcc)
         unsigned PID0:1;
         unsigned PID1:1;
         unsigned PID2:1;
         unsigned PID3:1;
-        unsigned :1;
-        unsigned UOWN:1;
+        unsigned :2;                    //UOWN
     };
     struct{
         unsigned :2;
@@ -132,44 +130,76 @@ extern byte usb_alt_intf[MAX_NUM_INT];
 
 extern volatile far BDT ep0Bo;          //Endpoint #0 BD Out
 extern volatile far BDT ep0Bi;          //Endpoint #0 BD In
-extern volatile far BDT ep1Bo;          //Endpoint #1 BD Out
-extern volatile far BDT ep1Bi;          //Endpoint #1 BD In
-extern volatile far BDT ep2Bo;          //Endpoint #2 BD Out
-extern volatile far BDT ep2Bi;          //Endpoint #2 BD In
-extern volatile far BDT ep3Bo;          //Endpoint #3 BD Out
-extern volatile far BDT ep3Bi;          //Endpoint #3 BD In
-extern volatile far BDT ep4Bo;          //Endpoint #4 BD Out
-extern volatile far BDT ep4Bi;          //Endpoint #4 BD In
-extern volatile far BDT ep5Bo;          //Endpoint #5 BD Out
-extern volatile far BDT ep5Bi;          //Endpoint #5 BD In
-extern volatile far BDT ep6Bo;          //Endpoint #6 BD Out
-extern volatile far BDT ep6Bi;          //Endpoint #6 BD In
-extern volatile far BDT ep7Bo;          //Endpoint #7 BD Out
-extern volatile far BDT ep7Bi;          //Endpoint #7 BD In
-extern volatile far BDT ep8Bo;          //Endpoint #8 BD Out
-extern volatile far BDT ep8Bi;          //Endpoint #8 BD In
-extern volatile far BDT ep9Bo;          //Endpoint #9 BD Out
-extern volatile far BDT ep9Bi;          //Endpoint #9 BD In
-extern volatile far BDT ep10Bo;         //Endpoint #10 BD Out
-extern volatile far BDT ep10Bi;         //Endpoint #10 BD In
-extern volatile far BDT ep11Bo;         //Endpoint #11 BD Out
-extern volatile far BDT ep11Bi;         //Endpoint #11 BD In
-extern volatile far BDT ep12Bo;         //Endpoint #12 BD Out
-extern volatile far BDT ep12Bi;         //Endpoint #12 BD In
-extern volatile far BDT ep13Bo;         //Endpoint #13 BD Out
-extern volatile far BDT ep13Bi;         //Endpoint #13 BD In
-extern volatile far BDT ep14Bo;         //Endpoint #14 BD Out
-extern volatile far BDT ep14Bi;         //Endpoint #14 BD In
-extern volatile far BDT ep15Bo;         //Endpoint #15 BD Out
-extern volatile far BDT ep15Bi;         //Endpoint #15 BD In
+extern volatile far BDT ep1BoE;         //Endpoint #1 BD Out Even
+extern volatile far BDT ep1BoO;         //Endpoint #1 BD Out Odd
+extern volatile far BDT ep1BiE;         //Endpoint #1 BD In Even
+extern volatile far BDT ep1BiO;         //Endpoint #1 BD In Odd
+extern volatile far BDT ep2BoE;         //Endpoint #2 BD Out Even
+extern volatile far BDT ep2BoO;         //Endpoint #2 BD Out Odd
+extern volatile far BDT ep2BiE;         //Endpoint #2 BD In Even
+extern volatile far BDT ep2BiO;         //Endpoint #2 BD In Odd
+extern volatile far BDT ep3BoE;         //Endpoint #3 BD Out Even
+extern volatile far BDT ep3BoO;         //Endpoint #3 BD Out Odd
+extern volatile far BDT ep3BiE;         //Endpoint #3 BD In Even
+extern volatile far BDT ep3BiO;         //Endpoint #3 BD In Odd
+extern volatile far BDT ep4BoE;         //Endpoint #4 BD Out Even
+extern volatile far BDT ep4BoO;         //Endpoint #4 BD Out Odd
+extern volatile far BDT ep4BiE;         //Endpoint #4 BD In Even
+extern volatile far BDT ep4BiO;         //Endpoint #4 BD In Odd
+extern volatile far BDT ep5BoE;         //Endpoint #5 BD Out Even
+extern volatile far BDT ep5BoO;         //Endpoint #5 BD Out Odd
+extern volatile far BDT ep5BiE;         //Endpoint #5 BD In Even
+extern volatile far BDT ep5BiO;         //Endpoint #5 BD In Odd
+extern volatile far BDT ep6BoE;         //Endpoint #6 BD Out Even
+extern volatile far BDT ep6BoO;         //Endpoint #6 BD Out Odd
+extern volatile far BDT ep6BiE;         //Endpoint #6 BD In Even
+extern volatile far BDT ep6BiO;         //Endpoint #6 BD In Odd
+extern volatile far BDT ep7BoE;         //Endpoint #7 BD Out Even
+extern volatile far BDT ep7BoO;         //Endpoint #7 BD Out Odd
+extern volatile far BDT ep7BiE;         //Endpoint #7 BD In Even
+extern volatile far BDT ep7BiO;         //Endpoint #7 BD In Odd
+extern volatile far BDT ep8BoE;         //Endpoint #8 BD Out Even
+extern volatile far BDT ep8BoO;         //Endpoint #8 BD Out Odd
+extern volatile far BDT ep8BiE;         //Endpoint #8 BD In Even
+extern volatile far BDT ep8BiO;         //Endpoint #8 BD In Odd
+extern volatile far BDT ep9BoE;         //Endpoint #9 BD Out Even
+extern volatile far BDT ep9BoO;         //Endpoint #9 BD Out Odd
+extern volatile far BDT ep9BiE;         //Endpoint #9 BD In Even
+extern volatile far BDT ep9BiO;         //Endpoint #9 BD In Odd
+extern volatile far BDT ep10BoE;        //Endpoint #10 BD Out Even
+extern volatile far BDT ep10BoO;        //Endpoint #10 BD Out Odd
+extern volatile far BDT ep10BiE;        //Endpoint #10 BD In Even
+extern volatile far BDT ep10BiO;        //Endpoint #10 BD In Odd
+extern volatile far BDT ep11BoE;        //Endpoint #11 BD Out Even
+extern volatile far BDT ep11BoO;        //Endpoint #11 BD Out Odd
+extern volatile far BDT ep11BiE;        //Endpoint #11 BD In Even
+extern volatile far BDT ep11BiO;        //Endpoint #11 BD In Odd
+extern volatile far BDT ep12BoE;        //Endpoint #12 BD Out Even
+extern volatile far BDT ep12BoO;        //Endpoint #12 BD Out Odd
+extern volatile far BDT ep12BiE;        //Endpoint #12 BD In Even
+extern volatile far BDT ep12BiO;        //Endpoint #12 BD In Odd
+extern volatile far BDT ep13BoE;        //Endpoint #13 BD Out Even
+extern volatile far BDT ep13BoO;        //Endpoint #13 BD Out Odd
+extern volatile far BDT ep13BiE;        //Endpoint #13 BD In Even
+extern volatile far BDT ep13BiO;        //Endpoint #13 BD In Odd
+extern volatile far BDT ep14BoE;        //Endpoint #14 BD Out Even
+extern volatile far BDT ep14BoO;        //Endpoint #14 BD Out Odd
+extern volatile far BDT ep14BiE;        //Endpoint #14 BD In Even
+extern volatile far BDT ep14BiO;        //Endpoint #14 BD In Odd
+extern volatile far BDT ep15BoE;        //Endpoint #15 BD Out Even
+extern volatile far BDT ep15BoO;        //Endpoint #15 BD Out Odd
+extern volatile far BDT ep15BiE;        //Endpoint #15 BD In Even
+extern volatile far BDT ep15BiO;        //Endpoint #15 BD In Odd
 
 extern volatile far CTRL_TRF_SETUP SetupPkt;
 extern volatile far CTRL_TRF_DATA CtrlTrfData;
 
 #if defined(USB_USE_HID)
 extern volatile far unsigned char hid_report_out[HID_INT_OUT_EP_SIZE];
-extern volatile far unsigned char hid_report_in[HID_INT_IN_EP_SIZE];
+extern volatile far unsigned char hid_report_in[2][HID_INT_IN_EP_SIZE];
 extern volatile far unsigned char hid_report_feature[HID_FEATURE_SIZE];
+extern volatile far unsigned char hid_vnd_report_in[2][HID_VND_INT_IN_EP_SIZE];
+extern volatile far unsigned char hid_vnd_report_feature[HID_VND_FEATURE_SIZE];
 #endif
 
 #endif //USBMMAP_H
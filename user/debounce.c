@@ -0,0 +1,66 @@
+#include "system\typedefs.h"
+#include "user\debounce.h"
+
+#pragma udata
+
+// Scans left in each key's window, bit n of the count in debounceCountn.
+unsigned char debounceCount0[N_DEBOUNCE_BYTES];
+unsigned char debounceCount1[N_DEBOUNCE_BYTES];
+unsigned char debounceCount2[N_DEBOUNCE_BYTES];
+unsigned char debounceWindow;
+
+#pragma code
+
+void DebounceInit(void)
+{
+  int i;
+
+  for (i = 0; i < N_DEBOUNCE_BYTES; i++) {
+    debounceCount0[i] = debounceCount1[i] = debounceCount2[i] = 0;
+  }
+}
+
+/** Set how many scans after an edge a key's changes are ignored. */
+void DebounceSetWindow(unsigned char scans)
+{
+  if (scans > DEBOUNCE_SCANS_MAX)
+    scans = DEBOUNCE_SCANS_MAX;
+  debounceWindow = scans;
+}
+
+/** Once per scan for each byte of keys: given their raw state and the
+ * state last reported, return those whose change should be reported
+ * now.  Counts down the windows of the others.
+ */
+unsigned char DebounceEdges(unsigned char i, unsigned char raw,
+                            unsigned char stable)
+{
+  unsigned char c0, c1, locked, borrow;
+
+  c0 = debounceCount0[i];
+  c1 = debounceCount1[i];
+  locked = c0 | c1 | debounceCount2[i];
+
+  // Decrement the nonzero counts, a borrow rippling up through the bits.
+  debounceCount0[i] = c0 ^ locked;
+  borrow = locked & ~c0;
+  debounceCount1[i] = c1 ^ borrow;
+  borrow &= ~c1;
+  debounceCount2[i] ^= borrow;
+
+  return (raw ^ stable) & ~locked;
+}
+
+/** Start the window for edges that have been reported. */
+void DebounceAccept(unsigned char i, unsigned char edges)
+{
+  debounceCount0[i] &= ~edges;
+  debounceCount1[i] &= ~edges;
+  debounceCount2[i] &= ~edges;
+  if (debounceWindow & 0x01)
+    debounceCount0[i] |= edges;
+  if (debounceWindow & 0x02)
+    debounceCount1[i] |= edges;
+  if (debounceWindow & 0x04)
+    debounceCount2[i] |= edges;
+}
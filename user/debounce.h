@@ -0,0 +1,20 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+// Eager debounce of a matrix of keys, eight to a byte.  A key's first
+// edge is reported at once; further changes are then ignored for the
+// window, so bounces are dropped without adding latency.  Each key has
+// a 3-bit count of the scans left in its window, kept as vertical
+// counters (one byte per bit of count), so a whole byte of keys is
+// handled with a few logic operations.
+
+#define N_DEBOUNCE_BYTES 16     // 128 keys.
+#define DEBOUNCE_SCANS_MAX 7    // Most a 3-bit count can hold.
+
+void DebounceInit(void);
+void DebounceSetWindow(unsigned char scans);
+unsigned char DebounceEdges(unsigned char i, unsigned char raw,
+                            unsigned char stable);
+void DebounceAccept(unsigned char i, unsigned char edges);
+
+#endif //DEBOUNCE_H
@@ -0,0 +1,53 @@
+#ifndef KEYS_H
+#define KEYS_H
+
+typedef enum {
+  NONE = 0,
+  L_SHIFT = 1, R_SHIFT, L_CONTROL, R_CONTROL, L_META, R_META, L_SUPER, R_SUPER,
+  L_HYPER, R_HYPER, L_SYMBOL, R_SYMBOL, L_GREEK, R_GREEK,
+  CAPS_LOCK, MODE_LOCK, ALT_LOCK,
+  REPEAT
+} KeyShift;
+
+// Note that C18 differs from standard C in that it (a) constant will
+// be char not int and (b) shift will be performed as char not int.
+#define SHIFT(s) (1L << s)
+
+#define L_TOP L_SYMBOL
+#define R_TOP R_SYMBOL
+
+#define L_ALT L_META
+#define R_ALT R_META
+#define L_GUI L_SUPER
+#define R_GUI R_SUPER
+
+#define MAX_USB_SHIFT R_GUI
+
+typedef unsigned char HidUsageID;
+
+// Keysym levels: plain, top (symbol) and greek.
+#define N_KEYSYM_LEVELS 3
+
+// Information about each key.
+typedef struct {
+  HidUsageID hidUsageID;        // Currently always from the Keyboard / Keypad page.
+  KeyShift shift;
+  // Index into Keysyms for each level, or 0 if an ordinary
+  // PC/AT-101 key with no symbol there.
+  unsigned char keysyms[N_KEYSYM_LEVELS];
+} KeyInfo;
+
+// As much as possible, keysyms are taken from <gdk/gdkkeysyms.h>,
+// which seems to be the most comprehensive list of X keysyms.
+
+#define NO_KEY(idx) { 0, NONE, { 0, 0, 0 } }
+#define SHIFT_KEY(idx,hid,shift) { hid, shift, { 0, 0, 0 } }
+#define PC_KEY(idx,hid,k0,k1,k2) { hid, NONE, { k0, k1, k2 } }
+// Currently the same, but might want a flag to say how standard the
+// non-symbol usage is.
+#define LISP_KEY(idx,hid,k0,k1,k2) { hid, NONE, { k0, k1, k2 } }
+
+// The tables themselves are generated from keymap\lmkbd.keys.
+#include "user\keytables.h"
+
+#endif //KEYS_H
@@ -0,0 +1,505 @@
+/* Generated by keymap/genkeys.py from keymap/lmkbd.keys.  Do not edit. */
+
+#include "system\typedefs.h"
+#include "user\keys.h"
+
+#pragma romdata
+
+// Sorted keysym names and their lengths.
+rom const char *rom Keysyms[N_KEYSYMS] = {
+  "", "abort", "alpha", "altmode", "approximate", "atsign", "backnext",
+  "beta", "boldlock", "braceleft", "braceright", "bracketleft",
+  "bracketright", "break", "broketleft", "broketright", "call",
+  "caret", "ceiling", "cent", "chi", "circle", "circleminus",
+  "circleplus", "circleslash", "circletimes", "clear", "clearinput",
+  "clearscreen", "colon", "complete", "contained", "dagger", "degree",
+  "del", "delta", "division", "doubbaselinedot", "doublearrow",
+  "doublebracketleft", "doublebracketright", "doubledagger",
+  "doublevertbar", "downarrow", "downtack", "epsilon", "escape", "eta",
+  "exists", "floor", "forall", "form", "function", "gamma",
+  "greaterthanequal", "guillemotleft", "guillemotright", "handleft",
+  "handright", "help", "holdoutput", "horizbar", "i", "identical",
+  "ii", "iii", "includes", "infinity", "integral", "intersection",
+  "iota", "itallock", "iv", "kappa", "lambda", "left",
+  "leftanglebracket", "leftarrow", "lefttack", "lessthanequal", "line",
+  "local", "logicaland", "logicalor", "macro", "middle", "mu",
+  "network", "notequal", "notsign", "nu", "omega", "omicron", "page",
+  "paragraph", "parenleft", "parenright", "partialderivative",
+  "periodcentered", "phi", "pi", "plusminus", "psi", "quad", "quote",
+  "refresh", "resume", "rho", "right", "rightanglebracket",
+  "rightarrow", "righttack", "scroll", "section", "select", "sigma",
+  "similarequal", "square", "status", "stopoutput", "suspend",
+  "system", "tau", "terminal", "theta", "thumbdown", "thumbup",
+  "times", "triangle", "undo", "union", "uparrow", "upsilon", "uptack",
+  "varsigma", "vartheta", "vertbar", "vt", "xi", "zeta"
+};
+
+rom const unsigned char KeysymLengths[N_KEYSYMS] = {
+  0, 5, 5, 7, 11, 6, 8, 4, 8, 9, 10, 11, 12, 5, 10, 11, 4, 5, 7, 4, 3,
+  6, 11, 10, 11, 11, 5, 10, 11, 5, 8, 9, 6, 6, 3, 5, 8, 15, 11, 17, 18,
+  12, 13, 9, 8, 7, 6, 3, 6, 5, 6, 4, 8, 5, 16, 13, 14, 8, 9, 4, 10, 8,
+  1, 9, 2, 3, 8, 8, 8, 12, 4, 8, 2, 5, 6, 4, 16, 9, 8, 13, 4, 5, 10, 9,
+  5, 6, 2, 7, 8, 7, 2, 5, 7, 4, 9, 9, 10, 17, 14, 3, 2, 9, 3, 4, 5, 7,
+  6, 3, 5, 17, 10, 9, 6, 7, 6, 5, 12, 6, 6, 10, 7, 6, 3, 8, 5, 9, 7, 5,
+  8, 4, 5, 7, 7, 6, 8, 8, 7, 2, 2, 4
+};
+
+rom KeyInfo TKKeys[64] = {
+  LISP_KEY(00, 0x9B, KS_break, KS_break, KS_break), /* break | cancel */
+  LISP_KEY(01, 0x29, KS_escape, KS_escape, KS_escape), /* esc */
+  PC_KEY(02, 0x1E, 0, 0, 0),     /* 1 ! */
+  PC_KEY(03, 0x1F, 0, 0, 0),     /* 2 " */
+  PC_KEY(04, 0x20, 0, 0, 0),     /* 3 # */
+  PC_KEY(05, 0x21, 0, 0, 0),     /* 4 $ */
+  PC_KEY(06, 0x22, 0, 0, 0),     /* 5 % */
+  PC_KEY(07, 0x23, 0, 0, 0),     /* 6 & */
+  PC_KEY(10, 0x24, 0, 0, 0),     /* 7 ' */
+  PC_KEY(11, 0x25, 0, 0, 0),     /* 8 ( */
+  PC_KEY(12, 0x26, 0, 0, 0),     /* 9 ) */
+  PC_KEY(13, 0x27, 0, 0, 0),     /* 0 _ */
+  PC_KEY(14, 0x2E, 0, 0, 0),     /* - = */
+  LISP_KEY(15, 0xCE, KS_atsign, KS_atsign, KS_atsign), /* @ ` | keypad @ */
+  LISP_KEY(16, 0xC3, KS_caret, KS_caret, KS_caret), /* ^ ~ | keypad ^ */
+  PC_KEY(17, 0x49, 0, 0, 0),     /* bs | insert */
+  LISP_KEY(20, 0xA0, KS_call, KS_call, KS_call), /* call | out */
+  LISP_KEY(21, 0x9C, KS_clear, KS_clear, KS_clear), /* clear */
+  PC_KEY(22, 0x2B, 0, 0, 0),     /* tab */
+  LISP_KEY(23, 0x29, KS_altmode, KS_altmode, KS_altmode), /* alt */
+  PC_KEY(24, 0x14, 0, 0, 0),     /* q conjunction */
+  PC_KEY(25, 0x1A, 0, 0, 0),     /* w disjunction */
+  PC_KEY(26, 0x08, 0, 0, 0),     /* e uplump */
+  PC_KEY(27, 0x15, 0, 0, 0),     /* r downlump */
+  PC_KEY(30, 0x17, 0, 0, 0),     /* t leftlump */
+  PC_KEY(31, 0x1C, 0, 0, 0),     /* y rightlump */
+  PC_KEY(32, 0x18, 0, 0, 0),     /* u elbow */
+  PC_KEY(33, 0x0C, 0, 0, 0),     /* i wheel */
+  PC_KEY(34, 0x12, 0, 0, 0),     /* o downarrow */
+  PC_KEY(35, 0x13, 0, 0, 0),     /* p uparrow */
+  PC_KEY(36, 0x2F, 0, 0, 0),     /* [ { */
+  PC_KEY(37, 0x30, 0, 0, 0),     /* ] } */
+  PC_KEY(40, 0x31, 0, 0, 0),     /* \ | */
+  PC_KEY(41, 0x54, 0, 0, 0),     /* / infinity | keypad / */
+  PC_KEY(42, 0x56, 0, 0, 0),     /* circle minus / delta | keypad - */
+  PC_KEY(43, 0x57, 0, 0, 0),     /* circle plus / del | keypad + */
+  LISP_KEY(44, 0x9F, KS_form, KS_form, KS_form), /* form | keypad separator */
+  LISP_KEY(45, 0x4E, KS_vt, KS_vt, KS_vt), /* vt | page down */
+  PC_KEY(46, 0x2A, 0, 0, 0),     /* rubout | delete (backspace) */
+  PC_KEY(47, 0x04, 0, 0, 0),     /* a less or equal */
+  PC_KEY(50, 0x16, 0, 0, 0),     /* s greater or equal */
+  PC_KEY(51, 0x07, 0, 0, 0),     /* d equivalence */
+  PC_KEY(52, 0x09, 0, 0, 0),     /* f partial */
+  PC_KEY(53, 0x0A, 0, 0, 0),     /* g not equal */
+  PC_KEY(54, 0x0B, 0, 0, 0),     /* h help */
+  PC_KEY(55, 0x0D, 0, 0, 0),     /* j leftarrow */
+  PC_KEY(56, 0x0E, 0, 0, 0),     /* k rightarrow */
+  PC_KEY(57, 0x0F, 0, 0, 0),     /* l botharrow */
+  PC_KEY(60, 0x33, 0, 0, 0),     /* ; plus */
+  LISP_KEY(61, 0xCB, KS_colon, KS_colon, KS_colon), /* : * | keypad : */
+  PC_KEY(62, 0x28, 0, 0, 0),     /* return | enter */
+  LISP_KEY(63, 0x58, KS_line, KS_line, KS_line), /* line | keypad enter */
+  LISP_KEY(64, 0x9D, KS_backnext, KS_backnext, KS_backnext), /* backnext | prior */
+  PC_KEY(65, 0x1D, 0, 0, 0),     /* z alpha */
+  PC_KEY(66, 0x1B, 0, 0, 0),     /* x beta */
+  PC_KEY(67, 0x06, 0, 0, 0),     /* c epsilon */
+  PC_KEY(70, 0x19, 0, 0, 0),     /* v lambda */
+  PC_KEY(71, 0x05, 0, 0, 0),     /* b pi */
+  PC_KEY(72, 0x11, 0, 0, 0),     /* n universal */
+  PC_KEY(73, 0x10, 0, 0, 0),     /* m existential */
+  PC_KEY(74, 0x36, 0, 0, 0),     /* , < */
+  PC_KEY(75, 0x37, 0, 0, 0),     /* . > */
+  PC_KEY(76, 0x38, 0, 0, 0),     /* / ? */
+  PC_KEY(77, 0x2C, 0, 0, 0)      /* space */
+};
+
+rom KeyInfo SpaceCadetKeys[128] = {
+  NO_KEY(000),
+  LISP_KEY(001, 0x43, KS_ii, KS_ii, KS_ii), /* II | F10 */
+  LISP_KEY(002, 0x45, KS_iv, KS_iv, KS_iv), /* IV | F12 */
+  SHIFT_KEY(003, 0x84, MODE_LOCK), /* mode lock | locking scroll lock */
+  NO_KEY(004),
+  SHIFT_KEY(005, 0xE3, L_SUPER), /* left super | left gui */
+  NO_KEY(006),
+  NO_KEY(007),
+  NO_KEY(010),
+  PC_KEY(011, 0x21, 0, 0, KS_cent), /* 4 */
+  PC_KEY(012, 0x15, 0, KS_union, KS_rho), /* r */
+  PC_KEY(013, 0x09, 0, KS_righttack, KS_phi), /* f */
+  PC_KEY(014, 0x19, 0, KS_similarequal, KS_varsigma), /* v */
+  SHIFT_KEY(015, 0x83, ALT_LOCK), /* alt lock | locking num lock */
+  NO_KEY(016),
+  LISP_KEY(017, 0x4F, KS_handright, 0, KS_circleslash), /* hand right | right arrow */
+  SHIFT_KEY(020, 0xE0, L_CONTROL), /* left control */
+  LISP_KEY(021, 0xCB, KS_colon, KS_plusminus, KS_section), /* plus minus | keypad : */
+  PC_KEY(022, 0x2B, 0, 0, 0),    /* tab */
+  PC_KEY(023, 0x2A, 0, 0, 0),    /* rubout | delete (backspace) */
+  SHIFT_KEY(024, 0xE1, L_SHIFT), /* left shift */
+  SHIFT_KEY(025, 0xE5, R_SHIFT), /* right shift */
+  SHIFT_KEY(026, 0xE4, R_CONTROL), /* right control */
+  NO_KEY(027),
+  LISP_KEY(030, 0x48, KS_holdoutput, KS_holdoutput, KS_holdoutput), /* hold output | pause */
+  PC_KEY(031, 0x25, 0, 0, KS_times), /* 8 */
+  PC_KEY(032, 0x0C, 0, KS_infinity, KS_iota), /* i */
+  PC_KEY(033, 0x0E, 0, KS_rightarrow, KS_kappa), /* k */
+  PC_KEY(034, 0x36, 0, 0, KS_guillemotleft), /* comma */
+  SHIFT_KEY(035, 0xED, R_GREEK), /* right greek */
+  LISP_KEY(036, 0x58, KS_line, KS_line, KS_line), /* line | keypad enter */
+  PC_KEY(037, 0x31, 0, 0, KS_doublevertbar), /* back slash */
+  LISP_KEY(040, 0xA1, KS_terminal, KS_terminal, KS_terminal), /* terminal | oper */
+  NO_KEY(041),
+  LISP_KEY(042, 0x76, KS_network, KS_network, KS_network), /* network | menu */
+  NO_KEY(043),
+  SHIFT_KEY(044, 0xEC, L_GREEK), /* left greek */
+  SHIFT_KEY(045, 0xE2, L_META),  /* left meta | left alt */
+  LISP_KEY(046, 0x9A, KS_status, KS_status, KS_status), /* status | sysreq / attention */
+  LISP_KEY(047, 0x9E, KS_resume, KS_resume, KS_resume), /* resume | return */
+  LISP_KEY(050, 0xA2, KS_clearscreen, KS_clearscreen, KS_clearscreen), /* clear screen | clear / again */
+  PC_KEY(051, 0x23, 0, 0, KS_quad), /* 6 */
+  PC_KEY(052, 0x1C, 0, KS_contained, KS_psi), /* y */
+  PC_KEY(053, 0x0B, 0, KS_downarrow, KS_eta), /* h */
+  PC_KEY(054, 0x11, 0, KS_lessthanequal, KS_nu), /* n */
+  NO_KEY(055),
+  NO_KEY(056),
+  NO_KEY(057),
+  NO_KEY(060),
+  PC_KEY(061, 0x1F, 0, 0, KS_doubledagger), /* 2 */
+  PC_KEY(062, 0x1A, 0, KS_logicalor, KS_omega), /* w */
+  PC_KEY(063, 0x16, 0, KS_uptack, KS_sigma), /* s */
+  PC_KEY(064, 0x1B, 0, KS_ceiling, KS_xi), /* x */
+  SHIFT_KEY(065, 0xE7, R_SUPER), /* right super | right gui */
+  NO_KEY(066),
+  LISP_KEY(067, 0x78, KS_abort, KS_abort, KS_abort), /* abort | stop */
+  NO_KEY(070),
+  PC_KEY(071, 0x26, 0, 0, KS_paragraph), /* 9 */
+  PC_KEY(072, 0x12, 0, KS_exists, KS_omicron), /* o */
+  PC_KEY(073, 0x0F, 0, KS_doublearrow, KS_lambda), /* l */
+  PC_KEY(074, 0x37, 0, 0, KS_guillemotright), /* period */
+  NO_KEY(075),
+  NO_KEY(076),
+  PC_KEY(077, 0x35, 0, 0, KS_notsign), /* back quote */
+  LISP_KEY(100, 0x79, KS_macro, KS_macro, KS_macro), /* macro | again */
+  LISP_KEY(101, 0x42, KS_i, KS_i, KS_i), /* I | F9 */
+  LISP_KEY(102, 0x44, KS_iii, KS_iii, KS_iii), /* III | F11 */
+  NO_KEY(103),
+  SHIFT_KEY(104, 0xEA, L_TOP),   /* left top */
+  NO_KEY(105),
+  LISP_KEY(106, 0x52, KS_thumbup, 0, KS_circleminus), /* up thumb | up arrow */
+  LISP_KEY(107, 0xA0, KS_call, KS_call, KS_call), /* call | out */
+  LISP_KEY(110, 0x9C, KS_clearinput, KS_clearinput, KS_clearinput), /* clear input | clear */
+  PC_KEY(111, 0x22, 0, 0, KS_degree), /* 5 */
+  PC_KEY(112, 0x17, 0, KS_includes, KS_tau), /* t */
+  PC_KEY(113, 0x0A, 0, KS_uparrow, KS_gamma), /* g */
+  PC_KEY(114, 0x05, 0, KS_identical, KS_beta), /* b */
+  SHIFT_KEY(115, 0xEE, REPEAT),  /* repeat */
+  LISP_KEY(116, 0x75, KS_help, KS_help, KS_help), /* help */
+  LISP_KEY(117, 0x50, KS_handleft, 0, KS_circletimes), /* hand left | left arrow */
+  LISP_KEY(120, 0xA4, KS_quote, KS_quote, KS_quote), /* quote | exsel */
+  PC_KEY(121, 0x1E, 0, 0, KS_dagger), /* 1 */
+  PC_KEY(122, 0x14, 0, KS_logicaland, KS_theta), /* q */
+  PC_KEY(123, 0x04, 0, KS_downtack, KS_alpha), /* a */
+  PC_KEY(124, 0x1D, 0, KS_floor, KS_zeta), /* z */
+  SHIFT_KEY(125, 0x82, CAPS_LOCK), /* caps lock | locking caps lock */
+  PC_KEY(126, 0x2E, 0, 0, KS_approximate), /* equals */
+  NO_KEY(127),
+  NO_KEY(130),
+  PC_KEY(131, 0x2D, 0, 0, KS_horizbar), /* minus */
+  LISP_KEY(132, 0xB6, KS_parenleft, KS_bracketleft, KS_doublebracketleft), /* ( | keypad ( */
+  PC_KEY(133, 0x34, 0, 0, KS_periodcentered), /* apostrophe */
+  PC_KEY(134, 0x2C, 0, 0, 0),    /* space */
+  NO_KEY(135),
+  PC_KEY(136, 0x28, 0, 0, 0),    /* return (enter) */
+  LISP_KEY(137, 0xB7, KS_parenright, KS_bracketright, KS_doublebracketright), /* ) | keypad ) */
+  NO_KEY(140),
+  LISP_KEY(141, 0x65, KS_system, KS_system, KS_system), /* system | application */
+  NO_KEY(142),
+  LISP_KEY(143, 0x29, KS_altmode, KS_altmode, KS_altmode), /* alt mode | escape */
+  NO_KEY(144),
+  SHIFT_KEY(145, 0xE8, L_HYPER), /* left hyper */
+  LISP_KEY(146, 0xB9, KS_braceright, KS_rightanglebracket, KS_broketright), /* } | keypad } */
+  NO_KEY(147),
+  NO_KEY(150),
+  PC_KEY(151, 0x24, 0, 0, KS_division), /* 7 */
+  PC_KEY(152, 0x18, 0, KS_forall, KS_upsilon), /* u */
+  PC_KEY(153, 0x0D, 0, KS_leftarrow, KS_vartheta), /* j */
+  PC_KEY(154, 0x10, 0, KS_greaterthanequal, KS_mu), /* m */
+  SHIFT_KEY(155, 0xEB, R_TOP),   /* right top */
+  PC_KEY(156, 0x4D, 0, 0, 0),    /* end */
+  PC_KEY(157, 0x4C, 0, 0, 0),    /* delete | delete forward */
+  PC_KEY(160, 0x49, 0, 0, 0),    /* overstrike | insert */
+  PC_KEY(161, 0x20, 0, 0, KS_del), /* 3 */
+  PC_KEY(162, 0x08, 0, KS_intersection, KS_epsilon), /* e */
+  PC_KEY(163, 0x07, 0, KS_lefttack, KS_delta), /* d */
+  PC_KEY(164, 0x06, 0, KS_notequal, KS_chi), /* c */
+  SHIFT_KEY(165, 0xE6, R_META),  /* right meta | right alt */
+  LISP_KEY(166, 0xB8, KS_braceleft, KS_leftanglebracket, KS_broketleft), /* { | keypad { */
+  LISP_KEY(167, 0x9B, KS_break, KS_break, KS_break), /* break | cancel */
+  LISP_KEY(170, 0x48, KS_stopoutput, KS_stopoutput, KS_stopoutput), /* stop output | pause */
+  PC_KEY(171, 0x27, 0, 0, KS_circle), /* 0 */
+  PC_KEY(172, 0x13, 0, KS_partialderivative, KS_pi), /* p */
+  PC_KEY(173, 0x33, 0, 0, KS_doubbaselinedot), /* semicolon */
+  PC_KEY(174, 0x38, 0, 0, KS_integral), /* question */
+  SHIFT_KEY(175, 0xE9, R_HYPER), /* right hyper */
+  LISP_KEY(176, 0x51, KS_thumbdown, 0, KS_circleplus), /* down thumb | down arrow */
+  NO_KEY(177)
+};
+
+rom KeyInfo ExplorerKeys[128] = {
+  NO_KEY(000),
+  LISP_KEY(001, 0x75, 0, 0, 0),  /* HELP */
+  NO_KEY(002),
+  SHIFT_KEY(003, 0x39, CAPS_LOCK), /* CAPS-LOCK */
+  LISP_KEY(004, 0xEE, KS_boldlock, KS_boldlock, KS_boldlock), /* BOLD-LOCK (shift key? LED?) */
+  LISP_KEY(005, 0xEF, KS_itallock, KS_itallock, KS_itallock), /* ITAL-LOCK (shift key? LED?) */
+  SHIFT_KEY(006, 0x47, MODE_LOCK), /* MODE-LOCK */
+  SHIFT_KEY(007, 0xE8, L_HYPER), /* LEFT-HYPER */
+  LISP_KEY(010, 0x65, KS_system, KS_system, KS_system), /* SYSTEM */
+  LISP_KEY(011, 0x76, KS_network, KS_network, KS_network), /* NETWORK */
+  LISP_KEY(012, 0x9A, KS_status, KS_status, KS_status), /* STATUS */
+  LISP_KEY(013, 0xA1, KS_terminal, KS_terminal, KS_terminal), /* TERMINAL */
+  NO_KEY(014),
+  LISP_KEY(015, 0xA2, KS_clearscreen, KS_clearscreen, KS_clearscreen), /* CLEAR-SCREEN */
+  LISP_KEY(016, 0x9C, KS_clearinput, KS_clearinput, KS_clearinput), /* CLEAR-INPUT */
+  LISP_KEY(017, 0x7A, KS_undo, KS_undo, KS_undo), /* UNDO */
+  PC_KEY(020, 0x4D, 0, 0, 0),    /* END */
+  LISP_KEY(021, 0x42, KS_left, KS_left, KS_left), /* LEFT (mouse keys? like i ii iii?) */
+  LISP_KEY(022, 0x43, KS_middle, KS_middle, KS_middle), /* MIDDLE */
+  LISP_KEY(023, 0x44, KS_right, KS_right, KS_right), /* RIGHT */
+  PC_KEY(024, 0x3A, 0, 0, 0),    /* F1 */
+  PC_KEY(025, 0x3B, 0, 0, 0),    /* F2 */
+  PC_KEY(026, 0x3C, 0, 0, 0),    /* F3 */
+  PC_KEY(027, 0x3D, 0, 0, 0),    /* F4 */
+  NO_KEY(030),
+  NO_KEY(031),
+  SHIFT_KEY(032, 0xE3, L_SUPER), /* LEFT-SUPER */
+  SHIFT_KEY(033, 0xE2, L_META),  /* LEFT-META */
+  SHIFT_KEY(034, 0xE0, L_CONTROL), /* LEFT-CONTROL */
+  SHIFT_KEY(035, 0xE4, R_CONTROL), /* RIGHT-CONTROL */
+  SHIFT_KEY(036, 0xE6, R_META),  /* RIGHT-META */
+  SHIFT_KEY(037, 0xE7, R_SUPER), /* RIGHT-SUPER */
+  SHIFT_KEY(040, 0xE9, R_HYPER), /* RIGHT-HYPER */
+  LISP_KEY(041, 0x9E, KS_resume, KS_resume, KS_resume), /* RESUME */
+  NO_KEY(042),
+  LISP_KEY(043, 0x29, KS_escape, KS_escape, KS_escape), /* ALT (ESCAPE actually?) */
+  PC_KEY(044, 0x1E, 0, 0, 0),    /* 1 */
+  PC_KEY(045, 0x1F, 0, 0, 0),    /* 2 */
+  PC_KEY(046, 0x20, 0, 0, 0),    /* 3 */
+  PC_KEY(047, 0x21, 0, 0, 0),    /* 4 */
+  PC_KEY(050, 0x22, 0, 0, 0),    /* 5 */
+  PC_KEY(051, 0x23, 0, 0, 0),    /* 6 */
+  PC_KEY(052, 0x24, 0, 0, 0),    /* 7 */
+  PC_KEY(053, 0x25, 0, 0, 0),    /* 8 */
+  PC_KEY(054, 0x26, 0, 0, 0),    /* 9 */
+  PC_KEY(055, 0x27, 0, 0, 0),    /* 0 */
+  PC_KEY(056, 0x2D, 0, 0, 0),    /* MINUS */
+  PC_KEY(057, 0x2E, 0, 0, 0),    /* EQUALS */
+  PC_KEY(060, 0xB8, 0, 0, 0),    /* BACK-QUOTE (` {) */
+  PC_KEY(061, 0xB9, 0, 0, 0),    /* TILDE (~ }) */
+  PC_KEY(062, 0x67, 0, 0, 0),    /* KEYPAD-EQUAL */
+  PC_KEY(063, 0x57, 0, 0, 0),    /* KEYPAD-PLUS */
+  PC_KEY(064, 0xCD, 0, 0, 0),    /* KEYPAD-SPACE */
+  PC_KEY(065, 0xBA, 0, 0, 0),    /* KEYPAD-TAB */
+  LISP_KEY(066, 0x9B, KS_break, KS_break, KS_break), /* BREAK */
+  NO_KEY(067),
+  PC_KEY(070, 0x2B, 0, 0, 0),    /* TAB */
+  PC_KEY(071, 0x14, 0, 0, 0),    /* Q */
+  PC_KEY(072, 0x1A, 0, 0, 0),    /* W */
+  PC_KEY(073, 0x08, 0, 0, 0),    /* E */
+  PC_KEY(074, 0x15, 0, 0, 0),    /* R */
+  PC_KEY(075, 0x17, 0, 0, 0),    /* T */
+  PC_KEY(076, 0x1C, 0, 0, 0),    /* Y */
+  PC_KEY(077, 0x18, 0, 0, 0),    /* U */
+  PC_KEY(100, 0x0C, 0, 0, 0),    /* I */
+  PC_KEY(101, 0x12, 0, 0, 0),    /* O */
+  PC_KEY(102, 0x13, 0, 0, 0),    /* P */
+  LISP_KEY(103, 0xB6, KS_parenleft, KS_bracketleft, KS_bracketleft), /* OPEN-PARENTHESIS */
+  LISP_KEY(104, 0xB7, KS_parenright, KS_bracketleft, KS_bracketleft), /* CLOSE-PARENTHESIS */
+  NO_KEY(105),
+  PC_KEY(106, 0x31, 0, 0, 0),    /* BACKSLASH */
+  PC_KEY(107, 0x52, 0, 0, 0),    /* UP-ARROW */
+  PC_KEY(110, 0x5F, 0, 0, 0),    /* KEYPAD-7 */
+  PC_KEY(111, 0x60, 0, 0, 0),    /* KEYPAD-8 */
+  PC_KEY(112, 0x61, 0, 0, 0),    /* KEYPAD-9 */
+  PC_KEY(113, 0x56, 0, 0, 0),    /* KEYPAD-MINUS */
+  LISP_KEY(114, 0x78, KS_abort, KS_abort, KS_abort), /* ABORT */
+  NO_KEY(115),
+  NO_KEY(116),
+  PC_KEY(117, 0x2A, 0, 0, 0),    /* RUBOUT */
+  PC_KEY(120, 0x04, 0, 0, 0),    /* A */
+  PC_KEY(121, 0x16, 0, 0, 0),    /* S */
+  PC_KEY(122, 0x07, 0, 0, 0),    /* D */
+  PC_KEY(123, 0x09, 0, 0, 0),    /* F */
+  PC_KEY(124, 0x0A, 0, 0, 0),    /* G */
+  PC_KEY(125, 0x0B, 0, 0, 0),    /* H */
+  PC_KEY(126, 0x0D, 0, 0, 0),    /* J */
+  PC_KEY(127, 0x0E, 0, 0, 0),    /* K */
+  PC_KEY(130, 0x0F, 0, 0, 0),    /* L */
+  PC_KEY(131, 0x33, 0, 0, 0),    /* SEMICOLON */
+  PC_KEY(132, 0x34, 0, 0, 0),    /* APOSTROPHE */
+  PC_KEY(133, 0x28, 0, 0, 0),    /* RETURN */
+  LISP_KEY(134, 0xA5, KS_line, KS_line, KS_line), /* LINE (others use keypad enter) */
+  PC_KEY(135, 0x50, 0, 0, 0),    /* LEFT-ARROW */
+  PC_KEY(136, 0x4A, 0, 0, 0),    /* HOME */
+  PC_KEY(137, 0x4F, 0, 0, 0),    /* RIGHT-ARROW */
+  PC_KEY(140, 0x5C, 0, 0, 0),    /* KEYPAD-4 */
+  PC_KEY(141, 0x5D, 0, 0, 0),    /* KEYPAD-5 */
+  PC_KEY(142, 0x5E, 0, 0, 0),    /* KEYPAD-6 */
+  PC_KEY(143, 0x85, 0, 0, 0),    /* KEYPAD-COMMA */
+  NO_KEY(144),
+  NO_KEY(145),
+  SHIFT_KEY(146, 0xEA, L_SYMBOL), /* LEFT-SYMBOL */
+  SHIFT_KEY(147, 0xE1, L_SHIFT), /* LEFT-SHIFT */
+  PC_KEY(150, 0x1D, 0, 0, 0),    /* Z */
+  PC_KEY(151, 0x1B, 0, 0, 0),    /* X */
+  PC_KEY(152, 0x06, 0, 0, 0),    /* C */
+  PC_KEY(153, 0x19, 0, 0, 0),    /* V */
+  PC_KEY(154, 0x05, 0, 0, 0),    /* B */
+  PC_KEY(155, 0x11, 0, 0, 0),    /* N */
+  PC_KEY(156, 0x10, 0, 0, 0),    /* M */
+  PC_KEY(157, 0x36, 0, 0, 0),    /* COMMA */
+  PC_KEY(160, 0x37, 0, 0, 0),    /* PERIOD */
+  PC_KEY(161, 0x38, 0, 0, 0),    /* QUESTION */
+  SHIFT_KEY(162, 0xE5, R_SHIFT), /* RIGHT-SHIFT */
+  NO_KEY(163),
+  SHIFT_KEY(164, 0xEB, R_SYMBOL), /* RIGHT-SYMBOL */
+  PC_KEY(165, 0x51, 0, 0, 0),    /* DOWN-ARROW */
+  PC_KEY(166, 0x59, 0, 0, 0),    /* KEYPAD-1 */
+  PC_KEY(167, 0x5A, 0, 0, 0),    /* KEYPAD-2 */
+  PC_KEY(170, 0x5B, 0, 0, 0),    /* KEYPAD-3 */
+  NO_KEY(171),
+  NO_KEY(172),
+  PC_KEY(173, 0x2C, 0, 0, 0),    /* SPACE */
+  NO_KEY(174),
+  PC_KEY(175, 0x62, 0, 0, 0),    /* KEYPAD-0 */
+  PC_KEY(176, 0x63, 0, 0, 0),    /* KEYPAD-PERIOD */
+  PC_KEY(177, 0x58, 0, 0, 0)     /* KEYPAD-ENTER */
+};
+
+rom KeyInfo SMBXKeyInfos[128] = {
+  NO_KEY(000),
+  NO_KEY(001),
+  LISP_KEY(002, 0xA1, KS_local, KS_local, KS_local), /* local | oper */
+  SHIFT_KEY(003, 0x82, CAPS_LOCK), /* caps lock | locking caps lock */
+  SHIFT_KEY(004, 0xE8, L_HYPER), /* left hyper */
+  SHIFT_KEY(005, 0xE2, L_META),  /* left meta | left alt */
+  SHIFT_KEY(006, 0xE4, R_CONTROL), /* right control */
+  SHIFT_KEY(007, 0xE7, R_SUPER), /* right super | right gui */
+  LISP_KEY(010, 0x4E, KS_scroll, KS_scroll, KS_scroll), /* scroll | page down */
+  SHIFT_KEY(011, 0x84, MODE_LOCK), /* mode lock | locking scroll lock */
+  NO_KEY(012),
+  NO_KEY(013),
+  NO_KEY(014),
+  LISP_KEY(015, 0x65, KS_select, KS_select, KS_select), /* select | application */
+  SHIFT_KEY(016, 0xEA, L_SYMBOL), /* left symbol */
+  SHIFT_KEY(017, 0xE3, L_SUPER), /* left super | left gui */
+  SHIFT_KEY(020, 0xE0, L_CONTROL), /* left control */
+  PC_KEY(021, 0x2C, 0, 0, 0),    /* space */
+  SHIFT_KEY(022, 0xE6, R_META),  /* right meta | right alt */
+  SHIFT_KEY(023, 0xE9, R_HYPER), /* right hyper */
+  PC_KEY(024, 0x4D, 0, 0, 0),    /* end */
+  NO_KEY(025),
+  NO_KEY(026),
+  NO_KEY(027),
+  PC_KEY(030, 0x1D, 0, 0, 0),    /* z */
+  PC_KEY(031, 0x06, 0, 0, 0),    /* c */
+  PC_KEY(032, 0x05, 0, 0, 0),    /* b */
+  PC_KEY(033, 0x10, 0, 0, 0),    /* m */
+  PC_KEY(034, 0x37, 0, 0, 0),    /* . */
+  SHIFT_KEY(035, 0xE5, R_SHIFT), /* right shift */
+  SHIFT_KEY(036, 0xEE, REPEAT),  /* repeat */
+  LISP_KEY(037, 0x78, KS_abort, KS_abort, KS_abort), /* abort | stop */
+  NO_KEY(040),
+  NO_KEY(041),
+  NO_KEY(042),
+  SHIFT_KEY(043, 0xE1, L_SHIFT), /* left shift */
+  PC_KEY(044, 0x1B, 0, 0, 0),    /* x */
+  PC_KEY(045, 0x19, 0, 0, 0),    /* v */
+  PC_KEY(046, 0x11, 0, 0, 0),    /* n */
+  PC_KEY(047, 0x36, 0, 0, 0),    /* , */
+  PC_KEY(050, 0x38, 0, 0, 0),    /* / */
+  SHIFT_KEY(051, 0xEB, R_SYMBOL), /* right symbol */
+  LISP_KEY(052, 0x75, KS_help, KS_help, KS_help), /* help */
+  NO_KEY(053),
+  NO_KEY(054),
+  NO_KEY(055),
+  PC_KEY(056, 0x2A, 0, 0, 0),    /* rubout | delete (backspace) */
+  PC_KEY(057, 0x16, 0, 0, 0),    /* s */
+  PC_KEY(060, 0x09, 0, 0, 0),    /* f */
+  PC_KEY(061, 0x0B, 0, 0, 0),    /* h */
+  PC_KEY(062, 0x0E, 0, 0, 0),    /* k */
+  PC_KEY(063, 0x33, 0, 0, 0),    /* ; */
+  PC_KEY(064, 0x28, 0, 0, 0),    /* return | enter */
+  LISP_KEY(065, 0xA4, KS_complete, KS_complete, KS_complete), /* complete | exsel */
+  NO_KEY(066),
+  NO_KEY(067),
+  NO_KEY(070),
+  LISP_KEY(071, 0x76, KS_network, KS_network, KS_network), /* network | menu */
+  PC_KEY(072, 0x04, 0, 0, 0),    /* a */
+  PC_KEY(073, 0x07, 0, 0, 0),    /* d */
+  PC_KEY(074, 0x0A, 0, 0, 0),    /* g */
+  PC_KEY(075, 0x0D, 0, 0, 0),    /* j */
+  PC_KEY(076, 0x0F, 0, 0, 0),    /* l */
+  PC_KEY(077, 0x34, 0, 0, 0),    /* ' */
+  LISP_KEY(100, 0x58, KS_line, KS_line, KS_line), /* line | keypad enter */
+  NO_KEY(101),
+  NO_KEY(102),
+  NO_KEY(103),
+  LISP_KEY(104, 0x79, KS_function, KS_function, KS_function), /* function | again */
+  PC_KEY(105, 0x1A, 0, 0, 0),    /* w */
+  PC_KEY(106, 0x15, 0, 0, 0),    /* r */
+  PC_KEY(107, 0x1C, 0, 0, 0),    /* y */
+  PC_KEY(110, 0x0C, 0, 0, 0),    /* i */
+  PC_KEY(111, 0x13, 0, 0, 0),    /* p */
+  LISP_KEY(112, 0xB7, KS_parenright, KS_parenright, KS_parenright), /* ) | keypad ) */
+  LISP_KEY(113, 0x9F, KS_page, KS_page, KS_page), /* page | keypad separator */
+  NO_KEY(114),
+  NO_KEY(115),
+  NO_KEY(116),
+  PC_KEY(117, 0x2B, 0, 0, 0),    /* tab */
+  PC_KEY(120, 0x14, 0, 0, 0),    /* q */
+  PC_KEY(121, 0x08, 0, 0, 0),    /* e */
+  PC_KEY(122, 0x17, 0, 0, 0),    /* t */
+  PC_KEY(123, 0x18, 0, 0, 0),    /* u */
+  PC_KEY(124, 0x12, 0, 0, 0),    /* o */
+  LISP_KEY(125, 0xB6, KS_parenleft, KS_parenleft, KS_parenleft), /* ( | keypad ( */
+  PC_KEY(126, 0x49, 0, 0, 0),    /* backspace | insert */
+  NO_KEY(127),
+  NO_KEY(130),
+  NO_KEY(131),
+  LISP_KEY(132, 0xCB, KS_colon, KS_colon, KS_colon), /* : | keypad : */
+  PC_KEY(133, 0x1F, 0, 0, 0),    /* 2 */
+  PC_KEY(134, 0x21, 0, 0, 0),    /* 4 */
+  PC_KEY(135, 0x23, 0, 0, 0),    /* 6 */
+  PC_KEY(136, 0x25, 0, 0, 0),    /* 8 */
+  PC_KEY(137, 0x27, 0, 0, 0),    /* 0 */
+  PC_KEY(140, 0x2E, 0, 0, 0),    /* = */
+  PC_KEY(141, 0x31, 0, 0, 0),    /* \ */
+  NO_KEY(142),
+  NO_KEY(143),
+  NO_KEY(144),
+  PC_KEY(145, 0x1E, 0, 0, 0),    /* 1 */
+  PC_KEY(146, 0x20, 0, 0, 0),    /* 3 */
+  PC_KEY(147, 0x22, 0, 0, 0),    /* 5 */
+  PC_KEY(150, 0x24, 0, 0, 0),    /* 7 */
+  PC_KEY(151, 0x26, 0, 0, 0),    /* 9 */
+  PC_KEY(152, 0x2D, 0, 0, 0),    /* - */
+  PC_KEY(153, 0x35, 0, 0, 0),    /* ` */
+  LISP_KEY(154, 0xC9, KS_vertbar, KS_vertbar, KS_vertbar), /* | | keypad | */
+  NO_KEY(155),
+  NO_KEY(156),
+  NO_KEY(157),
+  LISP_KEY(160, 0x29, KS_escape, KS_escape, KS_escape), /* escape */
+  LISP_KEY(161, 0xA2, KS_refresh, KS_refresh, KS_refresh), /* refresh | clear / again */
+  LISP_KEY(162, 0x42, KS_square, KS_square, KS_square), /* square | F9 */
+  LISP_KEY(163, 0x43, KS_circle, KS_circle, KS_circle), /* circle | F10 */
+  LISP_KEY(164, 0x44, KS_triangle, KS_triangle, KS_triangle), /* triangle | F11 */
+  LISP_KEY(165, 0x9C, KS_clearinput, KS_clearinput, KS_clearinput), /* clear input | clear */
+  LISP_KEY(166, 0x9B, KS_suspend, KS_suspend, KS_suspend), /* suspend | cancel */
+  LISP_KEY(167, 0x9E, KS_resume, KS_resume, KS_resume), /* resume | return */
+  NO_KEY(170),
+  NO_KEY(171),
+  NO_KEY(172),
+  NO_KEY(173),
+  NO_KEY(174),
+  NO_KEY(175),
+  NO_KEY(176),
+  NO_KEY(177)
+};
@@ -0,0 +1,156 @@
+/* Generated by keymap/genkeys.py from keymap/lmkbd.keys.  Do not edit. */
+
+#ifndef KEYTABLES_H
+#define KEYTABLES_H
+
+#define N_KEYSYMS 140          // Including 0, no keysym.
+
+#define KS_abort 1
+#define KS_alpha 2
+#define KS_altmode 3
+#define KS_approximate 4
+#define KS_atsign 5
+#define KS_backnext 6
+#define KS_beta 7
+#define KS_boldlock 8
+#define KS_braceleft 9
+#define KS_braceright 10
+#define KS_bracketleft 11
+#define KS_bracketright 12
+#define KS_break 13
+#define KS_broketleft 14
+#define KS_broketright 15
+#define KS_call 16
+#define KS_caret 17
+#define KS_ceiling 18
+#define KS_cent 19
+#define KS_chi 20
+#define KS_circle 21
+#define KS_circleminus 22
+#define KS_circleplus 23
+#define KS_circleslash 24
+#define KS_circletimes 25
+#define KS_clear 26
+#define KS_clearinput 27
+#define KS_clearscreen 28
+#define KS_colon 29
+#define KS_complete 30
+#define KS_contained 31
+#define KS_dagger 32
+#define KS_degree 33
+#define KS_del 34
+#define KS_delta 35
+#define KS_division 36
+#define KS_doubbaselinedot 37
+#define KS_doublearrow 38
+#define KS_doublebracketleft 39
+#define KS_doublebracketright 40
+#define KS_doubledagger 41
+#define KS_doublevertbar 42
+#define KS_downarrow 43
+#define KS_downtack 44
+#define KS_epsilon 45
+#define KS_escape 46
+#define KS_eta 47
+#define KS_exists 48
+#define KS_floor 49
+#define KS_forall 50
+#define KS_form 51
+#define KS_function 52
+#define KS_gamma 53
+#define KS_greaterthanequal 54
+#define KS_guillemotleft 55
+#define KS_guillemotright 56
+#define KS_handleft 57
+#define KS_handright 58
+#define KS_help 59
+#define KS_holdoutput 60
+#define KS_horizbar 61
+#define KS_i 62
+#define KS_identical 63
+#define KS_ii 64
+#define KS_iii 65
+#define KS_includes 66
+#define KS_infinity 67
+#define KS_integral 68
+#define KS_intersection 69
+#define KS_iota 70
+#define KS_itallock 71
+#define KS_iv 72
+#define KS_kappa 73
+#define KS_lambda 74
+#define KS_left 75
+#define KS_leftanglebracket 76
+#define KS_leftarrow 77
+#define KS_lefttack 78
+#define KS_lessthanequal 79
+#define KS_line 80
+#define KS_local 81
+#define KS_logicaland 82
+#define KS_logicalor 83
+#define KS_macro 84
+#define KS_middle 85
+#define KS_mu 86
+#define KS_network 87
+#define KS_notequal 88
+#define KS_notsign 89
+#define KS_nu 90
+#define KS_omega 91
+#define KS_omicron 92
+#define KS_page 93
+#define KS_paragraph 94
+#define KS_parenleft 95
+#define KS_parenright 96
+#define KS_partialderivative 97
+#define KS_periodcentered 98
+#define KS_phi 99
+#define KS_pi 100
+#define KS_plusminus 101
+#define KS_psi 102
+#define KS_quad 103
+#define KS_quote 104
+#define KS_refresh 105
+#define KS_resume 106
+#define KS_rho 107
+#define KS_right 108
+#define KS_rightanglebracket 109
+#define KS_rightarrow 110
+#define KS_righttack 111
+#define KS_scroll 112
+#define KS_section 113
+#define KS_select 114
+#define KS_sigma 115
+#define KS_similarequal 116
+#define KS_square 117
+#define KS_status 118
+#define KS_stopoutput 119
+#define KS_suspend 120
+#define KS_system 121
+#define KS_tau 122
+#define KS_terminal 123
+#define KS_theta 124
+#define KS_thumbdown 125
+#define KS_thumbup 126
+#define KS_times 127
+#define KS_triangle 128
+#define KS_undo 129
+#define KS_union 130
+#define KS_uparrow 131
+#define KS_upsilon 132
+#define KS_uptack 133
+#define KS_varsigma 134
+#define KS_vartheta 135
+#define KS_vertbar 136
+#define KS_vt 137
+#define KS_xi 138
+#define KS_zeta 139
+
+extern rom const char *rom Keysyms[N_KEYSYMS];
+extern rom const unsigned char KeysymLengths[N_KEYSYMS];
+
+extern rom KeyInfo TKKeys[64];
+extern rom KeyInfo SpaceCadetKeys[128];
+extern rom KeyInfo ExplorerKeys[128];
+extern rom KeyInfo SMBXKeyInfos[128];
+
+#endif //KEYTABLES_H
@@ -7,7 +7,10 @@
 #include "system\usb\usb.h"
 
 #include "io_cfg.h"
+#include "system\interrupt\interrupt.h"
 #include "user\user.h"
+#include "user\keys.h"
+#include "user\debounce.h"
 
 #include "delays.h"
 #include "string.h"
@@ -17,50 +20,9 @@ typedef enum {
 } Keyboard;
 
 typedef enum {
-  HUT1 = 1, EMACS
+  HUT1 = 1, EMACS, KEYSYM
 } TranslationMode;
 
-typedef enum {
-  NONE = 0, 
-  L_SHIFT = 1, R_SHIFT, L_CONTROL, R_CONTROL, L_META, R_META, L_SUPER, R_SUPER,
-  L_HYPER, R_HYPER, L_SYMBOL, R_SYMBOL, L_GREEK, R_GREEK,
-  CAPS_LOCK, MODE_LOCK, ALT_LOCK, 
-  REPEAT
-} KeyShift;
-
-// Note that C18 differs from standard C in that it (a) constant will
-// be char not int and (b) shift will be performed as char not int.
-#define SHIFT(s) (1L << s)
-
-#define L_TOP L_SYMBOL
-#define R_TOP R_SYMBOL
-
-#define L_ALT L_META
-#define R_ALT R_META
-#define L_GUI L_SUPER
-#define R_GUI R_SUPER
-
-#define MAX_USB_SHIFT R_GUI
-
-typedef unsigned char HidUsageID;
-
-// Information about each key.
-typedef struct {
-  HidUsageID hidUsageID;        // Currently always from the Keyboard / Keypad page.
-  KeyShift shift;
-  rom const char *keysym;       // Or NULL if an ordinary PC/AT-101 key with no symbol.
-} KeyInfo;
-
-// As much as possible, keysyms are taken from <gdk/gdkkeysyms.h>,
-// which seems to be the most comprehensive list of X keysyms.
-
-#define NO_KEY(idx) { 0, NONE, NULL }
-#define SHIFT_KEY(idx,hid,shift) { hid, shift, NULL }
-#define PC_KEY(idx,hid,keysym) { hid, NONE, keysym }
-// Currently the same, but might want a flag to say how standard the
-// non-symbol usage is.
-#define LISP_KEY(idx,hid,keysym) { hid, NONE, keysym }
-
 // Standard HID keyboard report.
 #define N_KEYS_REPORT 6
 
@@ -73,9 +35,18 @@ typedef union {
   };
 } KeyboardReport;
 
+#if defined(USB_USE_NKRO)
+// Report protocol keyboard report: one bit for each usage on the
+// Keyboard / Keypad page, so the modifiers are the E0-E7 byte.
+#define N_NKRO_BYTES (256 / 8)
+#endif
+
+// An Emacs event, as queued: its prefix flags and keysym.  The first
+// event's flags are cleared as its prefix goes out; how much of its
+// keysym has gone is in EmacsCharsSent.
 typedef struct {
   union {
-    unsigned all;
+    unsigned char all;
     struct {
       unsigned cxsent:1;
       unsigned atsent:1;
@@ -87,42 +58,208 @@ typedef struct {
       unsigned keysym:1;
     };
   } f;
-  rom const char *chars;
-  unsigned char nchars;
+  unsigned char keysymIndex;    // Index into Keysyms, or 0.
+  HidUsageID hidUsageID;        // KEYSYM mode: the key, for when no keysym.
+#if defined(USB_USE_TIMESTAMPS)
+  unsigned short time;          // When its key transition was detected.
+#endif
 } EmacsEvent;
 
+// KEYSYM mode vendor report: a whole event in one transaction.
+typedef union {
+  char chars[HID_VND_KEYSYM_RPT_SIZE];
+  struct {
+    unsigned char reportID;
+    unsigned char modifiers;
+    unsigned char keysymIndex;
+    HidUsageID hidUsageID;
+  };
+} KeysymReport;
+
+#define KEYSYM_CONTROL 0x01
+#define KEYSYM_META    0x02
+#define KEYSYM_SUPER   0x04
+#define KEYSYM_HYPER   0x08
+#define KEYSYM_SHIFT   0x10
+
+typedef enum {
+  KEY_DOWN = 0, KEY_UP, ALL_KEYS_UP, TK_KEY_DOWN
+} KeyEventType;
+
+// A raw key transition, as detected by the keyboard reader.
+typedef struct {
+  unsigned char type;           // KeyEventType.
+  unsigned char code;           // Index into the keyboard's KeyInfo table.
+  unsigned short shifts;        // Shift mask for ALL_KEYS_UP and TK_KEY_DOWN.
+  unsigned short time;          // Timer0 when detected.
+} KeyEvent;
+
 static void SendKeyReport(void);
+static void HIDTasks(void);
+static void LockHID(void);
+static void UnlockHID(void);
+static void AddKeyDown(HidUsageID key);
+static void RemoveKeyDown(HidUsageID key);
+static void ClearKeysDown(void);
+static BOOL IsKeyDown(HidUsageID key);
+static void TxKeyboardReport(HidUsageID *keys, unsigned char nkeys);
+static void TxChangedReport(char *buffer, unsigned char len,
+                            unsigned char stamp);
 static void CreateEmacsEvent(EmacsEvent *event, unsigned long shifts, 
-                             rom const char *keysym);
+                             rom const KeyInfo *key);
 static void SendEmacsEvent(void);
+static BOOL QueueKeysymEvent(rom const KeyInfo *key);
+static void SendKeysymEvent(void);
+static void StartRepeat(rom const KeyInfo *key);
+static void RepeatKeys(void);
 static void KeyDown(rom const KeyInfo *key);
 static void KeyUp(rom const KeyInfo *key);
+static BOOL PutKeyEvent(unsigned char type, unsigned char code, 
+                        unsigned short shifts);
+static void ProcessKeyEvents(void);
 
 static void InitMIT(void);
-static void ReadMIT(void);
+static void MITStartFrame(void);
+static void MITClockBit(void);
 static void InitTI(void);
-static void ReadTI(void);
+static void TIReceive(void);
 static void InitSMBX(void);
+static void SMBXTick(void);
 static void ScanSMBX(void);
+static void SetScanPeriod(unsigned char period);
+static void SetDebounceWindow(unsigned char ms);
+static void SetRepeat(unsigned char delay, unsigned char interval);
+static void InitPerf(void);
+static void CountLoop(void);
+static void SnapshotPerf(void);
+static unsigned char PutPerfShort(unsigned char i, unsigned short value);
+
+static void TKShiftKeys(unsigned short mask);
+static void SpaceCadetAllKeysUp(unsigned short mask);
 
 #pragma udata
 
 Keyboard CurrentKeyboard;
 TranslationMode CurrentMode;
+rom KeyInfo *CurrentKeyInfos;
 
 unsigned long CurrentShifts;
-HidUsageID KeysDown[16];
+// Keys down, as one bit per Keyboard / Keypad usage.  KeysDown has
+// them in the order pressed, for the keyboard report, only while
+// there are few enough to fit in it.
+unsigned char KeysDownMap[256 / 8];
+HidUsageID KeysDown[N_KEYS_REPORT];
 unsigned char NKeysDown;
 
-#define N_EMACS_EVENTS 8
+// A section of its own, so that the linker can give it a bank: 32
+// events of 3 bytes, 5 with timestamps.  When it is full, key events
+// wait in their queue, and the keyboards wait behind them, rather
+// than a key being sent without its keysym.
+#pragma udata emacs_events
+#define N_EMACS_EVENTS 32       // Must be a power of two.
 EmacsEvent EventBuffers[N_EMACS_EVENTS];
+#pragma udata
 unsigned char EmacsBufferIn, EmacsBufferOut;
 unsigned char EmacsBufferedCount;
+unsigned char EmacsCharsSent;   // Then one more for RET.
+
+// The keyboard report shares its endpoint with Emacs events, so waits
+// for them.  Keysym events go to the vendor interface instead.
+#define mKeyReportDeferred() \
+  ((EmacsBufferedCount > 0) && (CurrentMode != KEYSYM))
 
 KeyboardReport CurrentReport;
+// A keyboard report that could not go because the endpoint was still
+// busy.  Only the latest state matters, so later changes replace it.
+BOOL KeyReportPending;
+unsigned short KeyReportsDeferred, KeyReportsCoalesced;
+// Reports the same as the last sent are left out, except when the
+// host's idle rate (4 ms units, 0 for never) asks for one anyway.
+#define IDLE_COUNTS (PERF_COUNTS_PER_SECOND / 250)
+unsigned long IdleElapsed;      // Timer0 counts since the last report.
+BOOL IdleReportDue;
+#if defined(USB_INTERRUPT)
+unsigned char HIDLockDepth;     // Nested LockHID calls.
+#endif
+unsigned short ReportsSuppressed;
+#if defined(USB_USE_NKRO)
+char NKROReport[N_NKRO_BYTES + HID_TIMESTAMP_SIZE];
+#elif defined(USB_USE_TIMESTAMPS)
+char TimedReport[sizeof(KeyboardReport) + HID_TIMESTAMP_SIZE];
+#endif
+// When the key transition that the next report reflects was detected.
+unsigned short ReportTime;
+byte CurrentProtocol;
+
+// Key transitions, put at interrupt (or scan) level and taken by
+// UserTasks.  Only the producer writes KeyEventIn and only the
+// consumer KeyEventOut, and each is a single byte, so no locking.
+#define N_KEY_EVENTS 16         // Must be a power of two.
+volatile KeyEvent KeyEvents[N_KEY_EVENTS];
+volatile unsigned char KeyEventIn, KeyEventOut;
+volatile unsigned short KeyEventOverflows;
+
+#define mKeyEventsFull() \
+  (((KeyEventIn + 1) & (N_KEY_EVENTS - 1)) == KeyEventOut)
+
+// The MIT keyboard waits for the clock, so it is left waiting while
+// there is no room, rather than have its code dropped.
+volatile BOOL MITHeld;
 
 char CurrentLEDs;
 
+// Matrix scans are paced by Timer1, counting Fosc/4 / 8 = 1.5MHz at
+// 48MHz.  CCP1's special event trigger resets it at the end of each
+// period, so scans start at a fixed rate whatever else is going on,
+// and Timer1's count when the scan starts is how late it is.
+#define SCAN_COUNTS_PER_MS 1500
+#define SCAN_PERIOD_DEFAULT 2   // ms
+#define SCAN_PERIOD_MAX 43      // Most ms whose count fits in CCPR1.
+unsigned char CurrentScanPeriod;
+#define DEBOUNCE_MS_DEFAULT 5
+unsigned char CurrentDebounceMS;
+
+// While the REPEAT shift is held, the last key down that went as an
+// Emacs or keysym event is repeated, as a whole event.  The host
+// repeats ordinary keys itself, but would only repeat the last
+// character of an event.  Timed in Timer0 counts.
+#define REPEAT_DELAY_DEFAULT 50     // 10 ms units.
+#define REPEAT_INTERVAL_DEFAULT 33  // ms
+unsigned char CurrentRepeatDelay, CurrentRepeatInterval;
+unsigned long RepeatDelayCounts, RepeatIntervalCounts;
+long RepeatWait;
+rom const KeyInfo *RepeatingKey;
+
+// Performance counters, for the vendor interface's feature report.
+// All but the loop figures are running totals that wrap.  The report
+// is written out a field at a time, in this order after its ID, with
+// shorts low byte first and no padding.
+typedef struct {
+  unsigned short loopsPerSecond;
+  unsigned short worstLoopTime; // In the last second, Timer0 counts.
+  unsigned short reads;         // SMBX scans, MIT frames, TI bytes.
+  unsigned short keyEvents;     // Key transitions processed.
+  unsigned short keyEventsDropped;
+  unsigned short reportsSent;
+  unsigned short reportsDeferred;
+  unsigned short reportsCoalesced;
+  unsigned short emacsQueueFull;  // Passes that held key events back.
+  unsigned char emacsHighWater;
+  unsigned short mitUnknownFrames;
+  unsigned short tiErrors;      // Overruns and framing errors.
+  unsigned short reportsSuppressed; // The same as the last sent.
+} PerfReport;
+
+// Timer0 runs free at Fosc/4 / 64, 187.5kHz at 48MHz, to time the loop.
+#define PERF_COUNTS_PER_SECOND 187500L
+unsigned short PerfLastTime;
+unsigned short LoopElapsed;     // Since the pass before, for repeats too.
+unsigned long PerfTime;
+unsigned short LoopsCounted, WorstLoopTime;
+volatile unsigned short Reads, MITUnknownFrames;
+unsigned short KeyEventsProcessed, ReportsSent, EmacsQueueFull;
+unsigned char EmacsHighWater;
+
 #pragma code
 
 void UserInit(void)
@@ -138,28 +275,56 @@ void UserInit(void)
 
   hid_report_feature[0] = (byte)CurrentKeyboard;
   hid_report_feature[1] = (byte)CurrentMode;
+  // Scan period in ms, settable by the host, and the worst scan start
+  // jitter seen, in Timer1 counts (2/3 us).  The host writes 0 to the
+  // latter to start measuring again.
+  hid_report_feature[2] = SCAN_PERIOD_DEFAULT;
+  hid_report_feature[3] = 0;
+  // Debounce window in ms, likewise settable.
+  hid_report_feature[4] = DEBOUNCE_MS_DEFAULT;
+  CurrentDebounceMS = DEBOUNCE_MS_DEFAULT;
+  SetScanPeriod(SCAN_PERIOD_DEFAULT);
+  // Repeat delay in 10 ms units (0 for no repeating) and interval in
+  // ms, likewise.
+  SetRepeat(REPEAT_DELAY_DEFAULT, REPEAT_INTERVAL_DEFAULT);
 
   CurrentShifts = 0;
-  NKeysDown = 0;
-  for (i = 0; i < sizeof(KeysDown); i++)
-    KeysDown[i] = 0;
+  ClearKeysDown();
 
   EmacsBufferIn = EmacsBufferOut = 0;
   EmacsBufferedCount = 0;
+  EmacsCharsSent = 0;
+
+  KeyEventIn = KeyEventOut = 0;
+  MITHeld = FALSE;
+  KeyEventOverflows = 0;
 
   for (i = 0; i < sizeof(CurrentReport); i++) {
     CurrentReport.chars[i] = 0;
   }
+  CurrentProtocol = BOOT_PROTOCOL;
+  KeyReportPending = FALSE;
+  KeyReportsDeferred = KeyReportsCoalesced = 0;
+  IdleElapsed = 0;
+  IdleReportDue = FALSE;
+  ReportsSuppressed = 0;
+  InitPerf();
 
   switch (CurrentKeyboard) {
   case TK:
+    CurrentKeyInfos = TKKeys;
+    InitMIT();
+    break;
   case SPACE_CADET:
+    CurrentKeyInfos = SpaceCadetKeys;
     InitMIT();
     break;
   case TI:
+    CurrentKeyInfos = ExplorerKeys;
     InitTI();
     break;
   case SMBX:  
+    CurrentKeyInfos = SMBXKeyInfos;
     InitSMBX();
     break;
   }
@@ -168,33 +333,181 @@ void UserInit(void)
 // User Application USB tasks.
 void UserTasks(void)
 {   
-  CurrentMode = (TranslationMode)hid_report_feature[1];
-
-  switch (CurrentKeyboard) {
-  case TK:
-  case SPACE_CADET:
-    if (!TK_KBDIN)
-      ReadMIT();
-    break;
-  case TI:
-    ReadTI();
-    break;
-  case SMBX:  
-    ScanSMBX();
-    break;
+  CountLoop();
+
+  if (CurrentMode != (TranslationMode)hid_report_feature[1]) {
+    CurrentMode = (TranslationMode)hid_report_feature[1];
+    // Any queued events were for the old mode's endpoint.
+    EmacsBufferIn = EmacsBufferOut = 0;
+    EmacsBufferedCount = 0;
+    EmacsCharsSent = 0;
+    RepeatingKey = NULL;
   }
-  
+  if (CurrentScanPeriod != hid_report_feature[2])
+    SetScanPeriod(hid_report_feature[2]);
+  if (CurrentDebounceMS != hid_report_feature[4])
+    SetDebounceWindow(hid_report_feature[4]);
+  if ((CurrentRepeatDelay != hid_report_feature[5]) ||
+      (CurrentRepeatInterval != hid_report_feature[6]))
+    SetRepeat(hid_report_feature[5], hid_report_feature[6]);
+
+  // All keyboards are read at interrupt level; what they queued is
+  // taken here in one batch.
+  ProcessKeyEvents();
+  RepeatKeys();
+  if (EmacsBufferedCount > EmacsHighWater)
+    EmacsHighWater = EmacsBufferedCount;
+  if (MITHeld && !mKeyEventsFull()) {
+    // Room again: let the waiting keyboard send its code.
+    MITHeld = FALSE;
+    INTCON3bits.INT2IF = !TK_KBDIN;
+    INTCON3bits.INT2IE = 1;
+  }
+
+  LockHID();
+  HIDTasks();
+  UnlockHID();
+}
+
+// Send whatever reports are due and take any LEDs report, with the
+// USB interrupt locked out.
+void HIDTasks(void)
+{
   if ((usb_device_state < CONFIGURED_STATE) || (UCONbits.SUSPND == 1)) 
     return;
 
-  while ((EmacsBufferedCount > 0) && !mHIDTxIsBusy()) {
-    SendEmacsEvent();
+  if (KeyReportPending && !mHIDTxIsBusy()) {
+    // Before any Emacs events queued since, which reuse CurrentReport.
+    KeyReportPending = FALSE;
+    TxKeyboardReport(NULL, 0);
+  }
+
+  if ((CurrentProtocol != active_protocol) && !mHIDTxIsBusy()) {
+    // Host switched protocols: resend state in the new format.
+    CurrentProtocol = active_protocol;
+    if (!mKeyReportDeferred())
+      SendKeyReport();
+  }
+
+  if (idle_rate == 0)
+    IdleElapsed = 0;
+  else {
+    IdleElapsed += LoopElapsed;
+    if ((IdleElapsed >= (unsigned long)idle_rate * IDLE_COUNTS) &&
+        !KeyReportPending && !mKeyReportDeferred() && !mHIDTxIsBusy()) {
+      // Nothing new for the idle period: tell the host so.
+      IdleReportDue = TRUE;
+      TxKeyboardReport(NULL, 0);
+    }
+  }
+
+  if (CurrentMode == KEYSYM) {
+    while ((EmacsBufferedCount > 0) && !mHIDVndTxIsBusy()) {
+      SendKeysymEvent();
+    }
+  }
+  else {
+    while ((EmacsBufferedCount > 0) && !mHIDTxIsBusy()) {
+      SendEmacsEvent();
+    }
   }
 
   if (HIDRxReport(&CurrentLEDs, 1))
     LATA = CurrentLEDs;
 }
 
+// With USB_INTERRUPT, the ISR can run HIDInitEP, on SET_CONFIGURATION
+// or bus reset, and rewrite the BDs and ping-pong indexes the main
+// loop tests and stages reports into.  Keep it out meanwhile.  Nests.
+void LockHID(void)
+{
+#if defined(USB_INTERRUPT)
+  PIE2bits.USBIE = 0;
+  HIDLockDepth++;
+#endif
+}
+
+void UnlockHID(void)
+{
+#if defined(USB_INTERRUPT)
+  if (--HIDLockDepth == 0)
+    PIE2bits.USBIE = 1;
+#endif
+}
+
+// Keyboard interrupt service, called from interrupt.c.
+void UserInterrupt(void)
+{
+  if (INTCON3bits.INT2IF && INTCON3bits.INT2IE)
+    MITStartFrame();
+  if (PIR1bits.TMR2IF && PIE1bits.TMR2IE)
+    MITClockBit();
+  if (PIR1bits.CCP1IF && PIE1bits.CCP1IE)
+    SMBXTick();
+  if (PIR1bits.RCIF && PIE1bits.RCIE)
+    TIReceive();
+}
+
+// Queue a key transition for UserTasks.  Safe at interrupt level.
+// Returns FALSE if there was no room.
+BOOL PutKeyEvent(unsigned char type, unsigned char code, unsigned short shifts)
+{
+  unsigned char in, next;
+
+  in = KeyEventIn;
+  next = (in + 1) & (N_KEY_EVENTS - 1);
+  if (next == KeyEventOut) {
+    KeyEventOverflows++;        // Consumer is behind.
+    return FALSE;
+  }
+  KeyEvents[in].type = type;
+  KeyEvents[in].code = code;
+  KeyEvents[in].shifts = shifts;
+  KeyEvents[in].time = TMR0L;   // Latches TMR0H.
+  KeyEvents[in].time |= (unsigned short)TMR0H << 8;
+  KeyEventIn = next;            // Publish only once filled in.
+  return TRUE;
+}
+
+// Act on all queued key transitions.
+void ProcessKeyEvents(void)
+{
+  unsigned char out, type, code;
+  unsigned short shifts;
+
+  while ((out = KeyEventOut) != KeyEventIn) {
+    if (EmacsBufferedCount >= N_EMACS_EVENTS) {
+      // A key down might need another Emacs event.  Leave the rest
+      // until SendEmacsEvent has made room.
+      EmacsQueueFull++;
+      break;
+    }
+    type = KeyEvents[out].type;
+    code = KeyEvents[out].code;
+    shifts = KeyEvents[out].shifts;
+    ReportTime = KeyEvents[out].time;
+    KeyEventOut = (out + 1) & (N_KEY_EVENTS - 1);
+    KeyEventsProcessed++;
+
+    switch (type) {
+    case KEY_DOWN:
+      KeyDown(&CurrentKeyInfos[code]);
+      break;
+    case KEY_UP:
+      KeyUp(&CurrentKeyInfos[code]);
+      break;
+    case ALL_KEYS_UP:
+      SpaceCadetAllKeysUp(shifts);
+      break;
+    case TK_KEY_DOWN:
+      TKShiftKeys(shifts);
+      ClearKeysDown();          // There are no up transitions.
+      KeyDown(&CurrentKeyInfos[code]);
+      break;
+    }
+  }
+}
+
 // This sends an ordinary key report.
 void SendKeyReport(void)
 {
@@ -227,14 +540,87 @@ void SendKeyReport(void)
     }
   }
 
-  if (!mHIDTxIsBusy())
-    HIDTxReport(CurrentReport.chars, sizeof(CurrentReport));
+  LockHID();
+  if (!mHIDTxIsBusy()) {
+    KeyReportPending = FALSE;
+    TxKeyboardReport(NULL, 0);
+  }
+  else if (KeyReportPending)
+    KeyReportsCoalesced++;      // Replaces one not yet sent.
+  else {
+    KeyReportPending = TRUE;    // UserTasks sends when free.
+    KeyReportsDeferred++;
+  }
+  UnlockHID();
 }
 
-void KeyDown(rom const KeyInfo *key)
+// Send the keyboard report in whichever format the host asked for.
+// The boot report is CurrentReport; the NKRO report is built from
+// its shifts and the given keys, or all the keys down if NULL.
+void TxKeyboardReport(HidUsageID *keys, unsigned char nkeys)
 {
-  int i;
+#if defined(USB_USE_NKRO)
+  if (active_protocol == RPT_PROTOCOL) {
+    HidUsageID key;
+    int i;
+
+    if (keys == NULL) {
+      for (i = 0; i < N_NKRO_BYTES; i++) {
+        NKROReport[i] = KeysDownMap[i];
+      }
+    }
+    else {
+      for (i = 0; i < N_NKRO_BYTES; i++) {
+        NKROReport[i] = 0;
+      }
+      for (i = 0; i < nkeys; i++) {
+        key = keys[i];
+        if (key > 0x03)         // Not one of the error codes.
+          NKROReport[key / 8] |= (1 << (key % 8));
+      }
+    }
+    NKROReport[0xE0 / 8] = CurrentReport.shifts;
+#if defined(USB_USE_TIMESTAMPS)
+    NKROReport[N_NKRO_BYTES] = ReportTime & 0xFF;
+    NKROReport[N_NKRO_BYTES + 1] = ReportTime >> 8;
+#endif
+    TxChangedReport(NKROReport, sizeof(NKROReport), HID_TIMESTAMP_SIZE);
+    return;
+  }
+#elif defined(USB_USE_TIMESTAMPS)
+  if (active_protocol == RPT_PROTOCOL) {
+    int i;
+
+    for (i = 0; i < sizeof(KeyboardReport); i++) {
+      TimedReport[i] = CurrentReport.chars[i];
+    }
+    TimedReport[sizeof(KeyboardReport)] = ReportTime & 0xFF;
+    TimedReport[sizeof(KeyboardReport) + 1] = ReportTime >> 8;
+    TxChangedReport(TimedReport, sizeof(TimedReport), HID_TIMESTAMP_SIZE);
+    return;
+  }
+#endif
+  TxChangedReport(CurrentReport.chars, sizeof(CurrentReport), 0);
+}
+
+// Send a keyboard report, unless it is the same as the last one but
+// for its timestamp (the last stamp bytes), and so would tell the
+// host nothing, say on the release of a shift that the report does
+// not carry.  An idle report is the exception.
+void TxChangedReport(char *buffer, unsigned char len, unsigned char stamp)
+{
+  if (!IdleReportDue && HIDTxIsSameReport(buffer, len, len - stamp)) {
+    ReportsSuppressed++;
+    return;
+  }
+  IdleReportDue = FALSE;
+  IdleElapsed = 0;
+  HIDTxReport(buffer, len);
+  ReportsSent++;
+}
 
+void KeyDown(rom const KeyInfo *key)
+{
   switch (CurrentMode) {
   case EMACS:
     if (key->shift != NONE) {
@@ -244,23 +630,22 @@ void KeyDown(rom const KeyInfo *key)
       else
         return;                 // Don't send anything yet.
     }
-    if (key->keysym != NULL) {
-      if (EmacsBufferedCount < N_EMACS_EVENTS) {
-        EmacsEvent *event = &EventBuffers[EmacsBufferIn];
-        CreateEmacsEvent(event, CurrentShifts, key->keysym);
-        if (event->nchars > 0) {
-          // Found actual keysym; queue for sending.
-          EmacsBufferIn = (EmacsBufferIn + 1) % N_EMACS_EVENTS;
-          EmacsBufferedCount++;
-          return;
-        }
+    // ProcessKeyEvents has made sure that there is room.
+    {
+      EmacsEvent *event = &EventBuffers[EmacsBufferIn];
+      CreateEmacsEvent(event, CurrentShifts, key);
+      if (event->keysymIndex != 0) {
+        // Found actual keysym; queue for sending.
+        EmacsBufferIn = (EmacsBufferIn + 1) & (N_EMACS_EVENTS - 1);
+        EmacsBufferedCount++;
+        StartRepeat(key);
+        return;
       }
     }
-    if (NKeysDown < sizeof(KeysDown)) {
-      KeysDown[NKeysDown++] = key->hidUsageID;
-    }
-    if (CurrentShifts & (SHIFT(L_SUPER) | SHIFT(R_SUPER) | 
-                         SHIFT(L_HYPER) | SHIFT(R_HYPER))) {
+    AddKeyDown(key->hidUsageID);
+    if ((CurrentShifts & (SHIFT(L_SUPER) | SHIFT(R_SUPER) | 
+                          SHIFT(L_HYPER) | SHIFT(R_HYPER))) &&
+        (EmacsBufferedCount < N_EMACS_EVENTS)) {
       // An ordinary keysym, but with unusual shifts.  Send prefix.
       // When we later catch up, the actual key will be sent.
       EmacsEvent *event = &EventBuffers[EmacsBufferIn];
@@ -268,13 +653,31 @@ void KeyDown(rom const KeyInfo *key)
                        (CurrentShifts & (SHIFT(L_SUPER) | SHIFT(R_SUPER) | 
                                          SHIFT(L_HYPER) | SHIFT(R_HYPER))),
                        NULL);
-      EmacsBufferIn = (EmacsBufferIn + 1) % N_EMACS_EVENTS;
+      EmacsBufferIn = (EmacsBufferIn + 1) & (N_EMACS_EVENTS - 1);
       EmacsBufferedCount++;
+      StartRepeat(key);
       return;
     }
+    RepeatingKey = NULL;        // The host repeats it.
     if (EmacsBufferedCount > 0)
       return;                   // Will update after events.
     break;
+
+  case KEYSYM:
+    if (key->shift != NONE) {
+      CurrentShifts |= SHIFT(key->shift);
+      if (key->shift < L_SUPER)
+        break;                  // Send in report.
+      else
+        return;                 // Only sent with keysym events.
+    }
+    if (QueueKeysymEvent(key)) {
+      StartRepeat(key);
+      return;
+    }
+    RepeatingKey = NULL;
+    AddKeyDown(key->hidUsageID);
+    break;
     
   default:
     if (key->shift != NONE) {
@@ -282,9 +685,7 @@ void KeyDown(rom const KeyInfo *key)
       if (key->shift <= MAX_USB_SHIFT)
         break;                  // No need for usage entry.
     }
-    if (NKeysDown < sizeof(KeysDown)) {
-      KeysDown[NKeysDown++] = key->hidUsageID;
-    }
+    AddKeyDown(key->hidUsageID);
     break;
   }
 
@@ -293,33 +694,27 @@ void KeyDown(rom const KeyInfo *key)
 
 void KeyUp(rom const KeyInfo *key)
 {
-  char usage;
-  int i;
-
   if (key->shift != NONE) {
     CurrentShifts &= ~SHIFT(key->shift);
   }
+  if (key == RepeatingKey)
+    RepeatingKey = NULL;
 
-  usage = key->hidUsageID;
-  for (i = 0; i < NKeysDown; i++) {
-    if (KeysDown[i] == usage) {
-      NKeysDown--;
-      while (i < NKeysDown) {
-        KeysDown[i] = KeysDown[i+1];
-        i++;
-      }
-      break;
-    }
-  }
+  RemoveKeyDown(key->hidUsageID);
 
-  if (EmacsBufferedCount == 0)  // Otherwise will catch up after last event.
+  if (!mKeyReportDeferred())    // Otherwise will catch up after last event.
     SendKeyReport();
 }
 
 void CreateEmacsEvent(EmacsEvent *event, unsigned long shifts, 
-                      rom const char *keysym)
+                      rom const KeyInfo *key)
 {
+  unsigned char index;
+
   event->f.all = 0;
+#if defined(USB_USE_TIMESTAMPS)
+  event->time = ReportTime;
+#endif
   if (shifts & (SHIFT(L_HYPER) | SHIFT(R_HYPER)))
     event->f.hyper = 1;
   if (shifts & (SHIFT(L_SUPER) | SHIFT(R_SUPER)))
@@ -331,45 +726,18 @@ void CreateEmacsEvent(EmacsEvent *event, unsigned long shifts,
   if (shifts & (SHIFT(L_CONTROL) | SHIFT(R_CONTROL)))
     event->f.control = 1;
 
-  if (keysym == NULL) {
-    event->chars = NULL;
-    event->nchars = 0;
-  }
-  else {
-    rom const char *chars;
-    unsigned char nchars;
-    int n;
-    char ch;
-
-     if (shifts & (SHIFT(L_GREEK) | SHIFT(R_GREEK)))
-       n = 2;
-     else if (shifts & (SHIFT(L_SYMBOL) | SHIFT(R_SYMBOL)))
-       n = 1;
-     else
-       n = 0;
-    
-    chars = keysym;
-
-    do {
-      event->chars = chars;
-      nchars = 0;
-      while (TRUE) {
-        ch = *chars;
-        if (ch == '\0')
-          break;
-        chars++;
-        if (ch == ',')
-          break;
-        nchars++;
-      }
-      if (ch == '\0')
-        break;
-    } while (n-- > 0);
-
-    event->nchars = nchars;
+  if (key == NULL)
+    index = 0;
+  else if (shifts & (SHIFT(L_GREEK) | SHIFT(R_GREEK)))
+    index = key->keysyms[2];
+  else if (shifts & (SHIFT(L_SYMBOL) | SHIFT(R_SYMBOL)))
+    index = key->keysyms[1];
+  else
+    index = key->keysyms[0];
 
+  event->keysymIndex = index;
+  if (index != 0)
     event->f.keysym = 1;
-  }
 }
 
 char ASCII2HUT1(char ch)
@@ -388,24 +756,76 @@ char ASCII2HUT1(char ch)
   return 0;
 }
 
-char IsKeyDown(char key)
+BOOL IsKeyDown(HidUsageID key)
 {
-  int i;
   if (!key) return FALSE;
-  for (i = 0; i < NKeysDown; i++) {
-    if (KeysDown[i] == key)
-      return TRUE;
+  return ((KeysDownMap[key >> 3] & (1 << (key & 7))) != 0);
+}
+
+void AddKeyDown(HidUsageID key)
+{
+  if (!key || IsKeyDown(key)) return;
+  KeysDownMap[key >> 3] |= (1 << (key & 7));
+  if (NKeysDown < N_KEYS_REPORT)
+    KeysDown[NKeysDown] = key;
+  NKeysDown++;
+}
+
+void RemoveKeyDown(HidUsageID key)
+{
+  unsigned char i, j, bits;
+
+  if (!IsKeyDown(key)) return;
+  KeysDownMap[key >> 3] &= ~(1 << (key & 7));
+  NKeysDown--;
+  if (NKeysDown < N_KEYS_REPORT) {
+    for (i = 0; i < NKeysDown; i++) {
+      if (KeysDown[i] == key) {
+        while (i < NKeysDown) {
+          KeysDown[i] = KeysDown[i+1];
+          i++;
+        }
+        break;
+      }
+    }
+  }
+  else if (NKeysDown == N_KEYS_REPORT) {
+    // Fit again after rollover.  Press order is lost; take the map's.
+    j = 0;
+    for (i = 0; i < sizeof(KeysDownMap); i++) {
+      bits = KeysDownMap[i];
+      key = i << 3;
+      while (bits) {
+        if (bits & 1)
+          KeysDown[j++] = key;
+        bits >>= 1;
+        key++;
+      }
+    }
   }
-  return FALSE;
+}
+
+void ClearKeysDown(void)
+{
+  unsigned char i;
+
+  for (i = 0; i < sizeof(KeysDownMap); i++)
+    KeysDownMap[i] = 0;
+  NKeysDown = 0;
+  RepeatingKey = NULL;
 }
 
 void SendEmacsEvent(void)
 {
   EmacsEvent *event;
   HidUsageID key;
+  unsigned char index;
   int i;
 
   event = &EventBuffers[EmacsBufferOut];
+#if defined(USB_USE_TIMESTAMPS)
+  ReportTime = event->time;
+#endif
   
   // We try to avoid sending an extra report with no keys down between
   // characters.  However, when one is doubled, there is no alternative.
@@ -494,15 +914,15 @@ void SendEmacsEvent(void)
   }
   else {
     // Keysym stage.
-    if (event->chars != NULL) {
-      if (event->nchars > 0) {
-        key = ASCII2HUT1(*event->chars);
+    index = event->keysymIndex;
+    if ((index != 0) && (EmacsCharsSent <= KeysymLengths[index])) {
+      if (EmacsCharsSent < KeysymLengths[index]) {
+        key = ASCII2HUT1(Keysyms[index][EmacsCharsSent]);
         if (key == CurrentReport.keysDown[0])
           CurrentReport.keysDown[0] = 0;
         else {
           CurrentReport.keysDown[0] = key;
-          event->chars++;
-          event->nchars--;
+          EmacsCharsSent++;
         }
       }
       else {
@@ -511,7 +931,7 @@ void SendEmacsEvent(void)
           CurrentReport.keysDown[0] = 0;
         else {
           CurrentReport.keysDown[0] = key;
-          event->chars = NULL;
+          EmacsCharsSent++;
         }
       }
     }
@@ -521,8 +941,9 @@ void SendEmacsEvent(void)
           IsKeyDown(CurrentReport.keysDown[0]))
         CurrentReport.keysDown[0] = 0;
       else {
-        EmacsBufferOut = (EmacsBufferOut + 1) % N_EMACS_EVENTS;
+        EmacsBufferOut = (EmacsBufferOut + 1) & (N_EMACS_EVENTS - 1);
         EmacsBufferedCount--;
+        EmacsCharsSent = 0;
         if (EmacsBufferedCount == 0)
           // Catch up with actual key settings.
           SendKeyReport();
@@ -532,79 +953,112 @@ void SendEmacsEvent(void)
   }
 
   // Have already checked mHIDTxIsBusy().
-  HIDTxReport(CurrentReport.chars, sizeof(CurrentReport));
+  TxKeyboardReport(CurrentReport.keysDown, N_KEYS_REPORT);
 }
 
-/**** Knight keyboards ****/
+/**** Keysym events ****/
 
-#pragma udata
+// Queue a single vendor report for this key, if it has a keysym at
+// the current shift level or shifts that the keyboard report does not
+// carry.  Returns FALSE if it should just be an ordinary key.
+BOOL QueueKeysymEvent(rom const KeyInfo *key)
+{
+  EmacsEvent *event;
 
-rom KeyInfo TKKeys[64] = {
-  LISP_KEY(00, 0x9B, "break"),  /* break | cancel */
-  LISP_KEY(01, 0x29, "escape"), /* esc */
-  PC_KEY(02, 0x1E, NULL),       /* 1 ! */
-  PC_KEY(03, 0x1F, NULL),       /* 2 " */
-  PC_KEY(04, 0x20, NULL),       /* 3 # */
-  PC_KEY(05, 0x21, NULL),       /* 4 $ */
-  PC_KEY(06, 0x22, NULL),       /* 5 % */
-  PC_KEY(07, 0x23, NULL),       /* 6 & */
-  PC_KEY(10, 0x24, NULL),       /* 7 ' */
-  PC_KEY(11, 0x25, NULL),       /* 8 ( */
-  PC_KEY(12, 0x26, NULL),       /* 9 ) */
-  PC_KEY(13, 0x27, NULL),       /* 0 _ */
-  PC_KEY(14, 0x2E, NULL),       /* - = */
-  LISP_KEY(15, 0xCE, "atsign"), /* @ ` | keypad @ */
-  LISP_KEY(16, 0xC3, "caret"),  /* ^ ~ | keypad ^ */
-  PC_KEY(17, 0x49, NULL),       /* bs | insert */
-  LISP_KEY(20, 0xA0, "call"),   /* call | out */
-  LISP_KEY(21, 0x9C, "clear"),  /* clear */
-  PC_KEY(22, 0x2B, NULL),       /* tab */
-  LISP_KEY(23, 0x29, "altmode"), /* alt */
-  PC_KEY(24, 0x14, NULL),       /* q conjunction */
-  PC_KEY(25, 0x1A, NULL),       /* w disjunction */
-  PC_KEY(26, 0x08, NULL),       /* e uplump */
-  PC_KEY(27, 0x15, NULL),       /* r downlump */
-  PC_KEY(30, 0x17, NULL),       /* t leftlump */
-  PC_KEY(31, 0x1C, NULL),       /* y rightlump */
-  PC_KEY(32, 0x18, NULL),       /* u elbow */
-  PC_KEY(33, 0x0C, NULL),       /* i wheel */
-  PC_KEY(34, 0x12, NULL),       /* o downarrow */
-  PC_KEY(35, 0x13, NULL),       /* p uparrow */
-  PC_KEY(36, 0x2F, NULL),       /* [ { */
-  PC_KEY(37, 0x30, NULL),       /* ] } */
-  PC_KEY(40, 0x31, NULL),       /* \ | */
-  PC_KEY(41, 0x54, NULL),       /* / infinity | keypad / */
-  PC_KEY(42, 0x56, NULL),       /* circle minus / delta | keypad - */
-  PC_KEY(43, 0x57, NULL),       /* circle plus / del | keypad + */
-  LISP_KEY(44, 0x9F, "form"),   /* form | keypad separator */
-  LISP_KEY(45, 0x4E, "vt"),     /* vt | page down */
-  PC_KEY(46, 0x2A, NULL),       /* rubout | delete (backspace) */
-  PC_KEY(47, 0x04, NULL),       /* a less or equal */
-  PC_KEY(50, 0x16, NULL),       /* s greater or equal */
-  PC_KEY(51, 0x07, NULL),       /* d equivalence */
-  PC_KEY(52, 0x09, NULL),       /* f partial */
-  PC_KEY(53, 0x0A, NULL),       /* g not equal */
-  PC_KEY(54, 0x0B, NULL),       /* h help */
-  PC_KEY(55, 0x0D, NULL),       /* j leftarrow */
-  PC_KEY(56, 0x0E, NULL),       /* k rightarrow */
-  PC_KEY(57, 0x0F, NULL),       /* l botharrow */
-  PC_KEY(60, 0x33, NULL),       /* ; plus */
-  LISP_KEY(61, 0xCB, "colon"),  /* : * | keypad : */
-  PC_KEY(62, 0x28, NULL),       /* return | enter */
-  LISP_KEY(63, 0x58, "line"),   /* line | keypad enter */
-  LISP_KEY(64, 0x9D, "backnext"), /* backnext | prior */
-  PC_KEY(65, 0x1D, NULL),       /* z alpha */
-  PC_KEY(66, 0x1B, NULL),       /* x beta */
-  PC_KEY(67, 0x06, NULL),       /* c epsilon */
-  PC_KEY(70, 0x19, NULL),       /* v lambda */
-  PC_KEY(71, 0x05, NULL),       /* b pi */
-  PC_KEY(72, 0x11, NULL),       /* n universal */
-  PC_KEY(73, 0x10, NULL),       /* m existential */
-  PC_KEY(74, 0x36, NULL),       /* , < */
-  PC_KEY(75, 0x37, NULL),       /* . > */
-  PC_KEY(76, 0x38, NULL),       /* / ? */
-  PC_KEY(77, 0x2C, NULL)        /* space */
-};
+  if (EmacsBufferedCount >= N_EMACS_EVENTS)
+    return FALSE;               // ProcessKeyEvents should have waited.
+  event = &EventBuffers[EmacsBufferIn];
+  CreateEmacsEvent(event, CurrentShifts, key);
+  if ((event->keysymIndex == 0) && !event->f.super && !event->f.hyper)
+    return FALSE;
+  event->hidUsageID = key->hidUsageID;
+  EmacsBufferIn = (EmacsBufferIn + 1) & (N_EMACS_EVENTS - 1);
+  EmacsBufferedCount++;
+  return TRUE;
+}
+
+void SendKeysymEvent(void)
+{
+  EmacsEvent *event;
+  KeysymReport report;
+
+  event = &EventBuffers[EmacsBufferOut];
+
+  report.reportID = HID_VND_KEYSYM_RPT_ID;
+  report.modifiers = 0;
+  if (event->f.control)
+    report.modifiers |= KEYSYM_CONTROL;
+  if (event->f.meta)
+    report.modifiers |= KEYSYM_META;
+  if (event->f.super)
+    report.modifiers |= KEYSYM_SUPER;
+  if (event->f.hyper)
+    report.modifiers |= KEYSYM_HYPER;
+  if (event->f.shift)
+    report.modifiers |= KEYSYM_SHIFT;
+  report.keysymIndex = event->keysymIndex;
+  report.hidUsageID = event->hidUsageID;
+
+  EmacsBufferOut = (EmacsBufferOut + 1) & (N_EMACS_EVENTS - 1);
+  EmacsBufferedCount--;
+
+  // Have already checked mHIDVndTxIsBusy().
+  HIDVndTxReport(report.chars, sizeof(report));
+  ReportsSent++;
+}
+
+/**** Typematic repeat ****/
+
+// Repeat this key's event, after the delay, while REPEAT is held.
+void StartRepeat(rom const KeyInfo *key)
+{
+  RepeatingKey = key;
+  RepeatWait = RepeatDelayCounts;
+}
+
+// Queue the repeating key's event again if it is due.  A repeat waits
+// until no key events or Emacs events are left, so it never gets
+// ahead of what was actually typed, and only one is ever queued; time
+// lost waiting is not made up.
+void RepeatKeys(void)
+{
+  EmacsEvent *event;
+
+  if ((RepeatingKey == NULL) || !(CurrentShifts & SHIFT(REPEAT)) ||
+      (RepeatDelayCounts == 0)) {
+    RepeatWait = RepeatDelayCounts;
+    return;
+  }
+  RepeatWait -= LoopElapsed;
+  if ((RepeatWait > 0) || (KeyEventIn != KeyEventOut) ||
+      (EmacsBufferedCount > 0))
+    return;
+  RepeatWait = RepeatIntervalCounts;
+  ReportTime = PerfLastTime;    // Detected now, as it were.
+
+  if (CurrentMode == KEYSYM) {
+    QueueKeysymEvent(RepeatingKey);
+    return;
+  }
+  event = &EventBuffers[EmacsBufferIn];
+  CreateEmacsEvent(event, CurrentShifts, RepeatingKey);
+  if (event->keysymIndex == 0) {
+    if (!event->f.super && !event->f.hyper)
+      return;                   // Shifts let go: an ordinary key now.
+    // Just the prefix again; the key follows in the report, as it did
+    // the first time.
+    CreateEmacsEvent(event,
+                     (CurrentShifts & (SHIFT(L_SUPER) | SHIFT(R_SUPER) |
+                                       SHIFT(L_HYPER) | SHIFT(R_HYPER))),
+                     NULL);
+  }
+  EmacsBufferIn = (EmacsBufferIn + 1) & (N_EMACS_EVENTS - 1);
+  EmacsBufferedCount++;
+}
+
+/**** Knight keyboards ****/
+
+// Key tables are in keytables.c, generated from keymap\lmkbd.keys.
 
 static void TKShiftKeys(unsigned short mask)
 {
@@ -627,150 +1081,35 @@ static void TKShiftKeys(unsigned short mask)
 
 /**** Space Cadet keyboards ****/
 
-#pragma udata
-
-rom KeyInfo SpaceCadetKeys[128] = {
-  NO_KEY(000),
-  LISP_KEY(001, 0x43, "ii"),    /* II | F10 */
-  LISP_KEY(002, 0x45, "iv"),    /* IV | F12 */
-  SHIFT_KEY(003, 0x84, MODE_LOCK), /* mode lock | locking scroll lock */
-  NO_KEY(004),
-  SHIFT_KEY(005, 0xE3, L_SUPER), /* left super | left gui */
-  NO_KEY(006),
-  NO_KEY(007),
-  NO_KEY(010),
-  PC_KEY(011, 0x21, ",,cent"),  /* 4 */
-  PC_KEY(012, 0x15, ",union,rho"),   /* r */
-  PC_KEY(013, 0x09, ",righttack,phi"),   /* f */
-  PC_KEY(014, 0x19, ",similarequal,varsigma"), /* v */
-  SHIFT_KEY(015, 0x83, ALT_LOCK), /* alt lock | locking num lock */
-  NO_KEY(016),
-  LISP_KEY(017, 0x4F, "handright,,circleslash"), /* hand right | right arrow */
-  SHIFT_KEY(020, 0xE0, L_CONTROL), /* left control */
-  LISP_KEY(021, 0xCB, "colon,plusminus,section"), /* plus minus | keypad : */
-  PC_KEY(022, 0x2B, NULL),      /* tab */
-  PC_KEY(023, 0x2A, NULL),      /* rubout | delete (backspace) */
-  SHIFT_KEY(024, 0xE1, L_SHIFT), /* left shift */
-  SHIFT_KEY(025, 0xE5, R_SHIFT), /* right shift */
-  SHIFT_KEY(026, 0xE4, R_CONTROL), /* right control */
-  NO_KEY(027),
-  LISP_KEY(030, 0x48, "holdoutput"), /* hold output | pause */
-  PC_KEY(031, 0x25, ",,times"), /* 8 */
-  PC_KEY(032, 0x0C, ",infinity,iota"), /* i */
-  PC_KEY(033, 0x0E, ",rightarrow,kappa"), /* k */
-  PC_KEY(034, 0x36, ",,guillemotleft"), /* comma */
-  SHIFT_KEY(035, 0xED, R_GREEK), /* right greek */
-  LISP_KEY(036, 0x58, "line"),  /* line | keypad enter */
-  PC_KEY(037, 0x31, ",,doublevertbar"), /* back slash */
-  LISP_KEY(040, 0xA1, "terminal"), /* terminal | oper */
-  NO_KEY(041),
-  LISP_KEY(042, 0x76, "network"), /* network | menu */
-  NO_KEY(043),
-  SHIFT_KEY(044, 0xEC, L_GREEK), /* left greek */
-  SHIFT_KEY(045, 0xE2, L_META), /* left meta | left alt */
-  LISP_KEY(046, 0x9A, "status"), /* status | sysreq / attention */
-  LISP_KEY(047, 0x9E, "resume"), /* resume | return */
-  LISP_KEY(050, 0xA2, "clearscreen"), /* clear screen	| clear / again */
-  PC_KEY(051, 0x23, ",,quad"),  /* 6 */
-  PC_KEY(052, 0x1C, ",contained,psi"),   /* y */
-  PC_KEY(053, 0x0B, ",downarrow,eta"),   /* h */
-  PC_KEY(054, 0x11, ",lessthanequal,nu"),    /* n */
-  NO_KEY(055),
-  NO_KEY(056),
-  NO_KEY(057),
-  NO_KEY(060),
-  PC_KEY(061, 0x1F, ",,doubledagger"), /* 2 */
-  PC_KEY(062, 0x1A, ",logicalor,omega"), /* w */
-  PC_KEY(063, 0x16, ",uptack,sigma"), /* s */
-  PC_KEY(064, 0x1B, ",ceiling,xi"),    /* x */
-  SHIFT_KEY(065, 0xE7, R_SUPER), /* right super | right gui */
-  NO_KEY(066),
-  LISP_KEY(067, 0x78, "abort"), /* abort | stop */
-  NO_KEY(070),
-  PC_KEY(071, 0x26, ",,paragraph"), /* 9 */
-  PC_KEY(072, 0x12, ",exists,omicron"), /* o */
-  PC_KEY(073, 0x0F, ",doublearrow,lambda"), /* l */
-  PC_KEY(074, 0x37, ",,guillemotright"),/* period */
-  NO_KEY(075),
-  NO_KEY(076),
-  PC_KEY(077, 0x35, ",,notsign"), /* back quote */
-  LISP_KEY(100, 0x79, "macro"), /* macro | again */
-  LISP_KEY(101, 0x42, "i"),     /* I | F9 */
-  LISP_KEY(102, 0x44, "iii"),   /* III | F11 */
-  NO_KEY(103),
-  SHIFT_KEY(104, 0xEA, L_TOP),  /* left top */
-  NO_KEY(105),
-  LISP_KEY(106, 0x52, "thumbup,,circleminus"), /* up thumb | up arrow */
-  LISP_KEY(107, 0xA0, "call"),  /* call | out */
-  LISP_KEY(110, 0x9C, "clearinput"), /* clear input | clear */
-  PC_KEY(111, 0x22, ",,degree"), /* 5 */
-  PC_KEY(112, 0x17, ",includes,tau"),   /* t */
-  PC_KEY(113, 0x0A, ",uparrow,gamma"), /* g */
-  PC_KEY(114, 0x05, ",identical,beta"),  /* b */
-  SHIFT_KEY(115, 0xEE, REPEAT), /* repeat */
-  LISP_KEY(116, 0x75, "help"),  /* help */
-  LISP_KEY(117, 0x50, "handleft,,circletimes"), /* hand left | left arrow */
-  LISP_KEY(120, 0xA4, "quote"), /* quote | exsel */
-  PC_KEY(121, 0x1E, ",,dagger"), /* 1 */
-  PC_KEY(122, 0x14, ",logicaland,theta"), /* q */
-  PC_KEY(123, 0x04, ",downtack,alpha"), /* a */
-  PC_KEY(124, 0x1D, ",floor,zeta"),  /* z */
-  SHIFT_KEY(125, 0x82, CAPS_LOCK), /* caps lock | locking caps lock */
-  PC_KEY(126, 0x2E, ",,approximate"), /* equals */
-  NO_KEY(127),
-  NO_KEY(130),
-  PC_KEY(131, 0x2D, ",,horizbar"), /* minus */
-  LISP_KEY(132, 0xB6, "parenleft,bracketleft,doublebracketleft"), /* ( | keypad ( */
-  PC_KEY(133, 0x34, ",,periodcentered"), /* apostrophe */
-  PC_KEY(134, 0x2C, NULL),      /* space */
-  NO_KEY(135),
-  PC_KEY(136, 0x28, NULL),      /* return (enter) */
-  LISP_KEY(137, 0xB7, "parenright,bracketright,doublebracketright"), /* ) | keypad ) */
-  NO_KEY(140),
-  LISP_KEY(141, 0x65, "system"), /* system | application */
-  NO_KEY(142),
-  LISP_KEY(143, 0x29, "altmode"), /* alt mode | escape */
-  NO_KEY(144),
-  SHIFT_KEY(145, 0xE8, L_HYPER), /* left hyper */
-  LISP_KEY(146, 0xB9, "braceright,rightanglebracket,broketright"), /* } | keypad } */
-  NO_KEY(147),
-  NO_KEY(150),
-  PC_KEY(151, 0x24, ",,division"), /* 7 */
-  PC_KEY(152, 0x18, ",forall,upsilon"), /* u */
-  PC_KEY(153, 0x0D, ",leftarrow,vartheta"), /* j */
-  PC_KEY(154, 0x10, ",greaterthanequal,mu"),    /* m */
-  SHIFT_KEY(155, 0xEB, R_TOP),  /* right top */
-  PC_KEY(156, 0x4D, NULL),      /* end */
-  PC_KEY(157, 0x4C, NULL),      /* delete | delete forward */
-  PC_KEY(160, 0x49, NULL),      /* overstrike | insert */
-  PC_KEY(161, 0x20, ",,del"),   /* 3 */
-  PC_KEY(162, 0x08, ",intersection,epsilon"), /* e */
-  PC_KEY(163, 0x07, ",lefttack,delta"), /* d */
-  PC_KEY(164, 0x06, ",notequal,chi"),   /* c */
-  SHIFT_KEY(165, 0xE6, R_META), /* right meta | right alt */
-  LISP_KEY(166, 0xB8, "braceleft,leftanglebracket,broketleft"), /* { | keypad { */
-  LISP_KEY(167, 0x9B, "break"), /* break | cancel */
-  LISP_KEY(170, 0x48, "stopoutput"), /* stop output | pause */
-  PC_KEY(171, 0x27, ",,circle"), /* 0 */
-  PC_KEY(172, 0x13, ",partialderivative,pi"), /* p */
-  PC_KEY(173, 0x33, ",,doubbaselinedot"), /* semicolon */
-  PC_KEY(174, 0x38, ",,integral"), /* question */
-  SHIFT_KEY(175, 0xE9, R_HYPER), /* right hyper */
-  LISP_KEY(176, 0x51, "thumbdown,,circleplus"), /* down thumb | down arrow */
-  NO_KEY(177)
+// Shift keys that are sent as ordinary usage ids instead of in the
+// prefix, and so may stay down across all keys up.
+typedef struct {
+  HidUsageID hidUsageID;
+  KeyShift shift;
+} UsageShift;
+
+#define N_USAGE_SHIFTS 10
+rom UsageShift UsageShifts[N_USAGE_SHIFTS] = {
+  { 0x82, CAPS_LOCK },
+  { 0x83, ALT_LOCK },
+  { 0x84, MODE_LOCK },
+  { 0xE8, L_HYPER },
+  { 0xE9, R_HYPER },
+  { 0xEA, L_SYMBOL },
+  { 0xEB, R_SYMBOL },
+  { 0xEC, L_GREEK },
+  { 0xED, R_GREEK },
+  { 0xEE, REPEAT }
 };
 
-#pragma code
-
 static void SpaceCadetAllKeysUp(unsigned short mask)
 {
-  HidUsageID key;
-  unsigned long shift;
-  int i, j;
+  HidUsageID key, kept[N_USAGE_SHIFTS];
+  unsigned char i, nkept;
 
   if (0 == mask) {
     CurrentShifts = 0;
-    NKeysDown = 0;
+    ClearKeysDown();
   }
   else {
 #define UPDATE_SHIFTS_LR(n,s)                   \
@@ -791,46 +1130,27 @@ static void SpaceCadetAllKeysUp(unsigned short mask)
     UPDATE_SHIFTS(9,MODE_LOCK);
     UPDATE_SHIFTS(10,REPEAT);
 
-    j = 0;
-    for (i = 0; i < NKeysDown; i++) {
-      key = KeysDown[i];
-      // Check for shift keys that are sent as ordinary usage ids
-      // instead of in the prefix.
-      switch (key) {
-#define MAP_SHIFT(u,s)          \
-      case u:                   \
-        shift = SHIFT(s);       \
-        break;
-
-      MAP_SHIFT(0x82,CAPS_LOCK);
-      MAP_SHIFT(0x83,ALT_LOCK);
-      MAP_SHIFT(0x84,MODE_LOCK);
-      MAP_SHIFT(0xE8,L_HYPER);
-      MAP_SHIFT(0xE9,R_HYPER);
-      MAP_SHIFT(0xEA,L_SYMBOL);
-      MAP_SHIFT(0xEB,R_SYMBOL);
-      MAP_SHIFT(0xEC,L_GREEK);
-      MAP_SHIFT(0xED,R_GREEK);
-      MAP_SHIFT(0xEE,REPEAT);
-
-      default:
-        shift = 0;
-      }
-      if (CurrentShifts & shift) {
+    nkept = 0;
+    for (i = 0; i < N_USAGE_SHIFTS; i++) {
+      key = UsageShifts[i].hidUsageID;
+      if (IsKeyDown(key) && (CurrentShifts & SHIFT(UsageShifts[i].shift))) {
         // A still active shifting key is preserved.
-        if (j != i)
-          KeysDown[j] = key;
-        j++;
+        kept[nkept++] = key;
       }
     }
-    NKeysDown = j;
+    ClearKeysDown();
+    for (i = 0; i < nkept; i++) {
+      AddKeyDown(kept[i]);
+    }
   }
-  if (EmacsBufferedCount == 0)
+  if (!mKeyReportDeferred())
     SendKeyReport();
 }
 
 #pragma udata
 
+// Code being clocked in at interrupt level.
+unsigned char mitBit;
 unsigned char tkBits[3];
 
 #pragma code
@@ -838,337 +1158,151 @@ unsigned char tkBits[3];
 void InitMIT(void)
 {
   TK_KBDCLK = 1;                // Clock idle until data goes low.
+
+  // Timer2 paces the clock: 1:4 prescale, 100 count period is 400
+  // cycles per half bit, same as the old Delay100TCYx(4).
+  T2CON = 0x01;
+  PR2 = 99;
+  PIE1bits.TMR2IE = 0;
+
+  // Keyboard pulling data low (on INT2) starts a code.
+  INTCON2bits.INTEDG2 = 0;      // Falling edge.
+  INTCON3bits.INT2IF = 0;
+  INTCON3bits.INT2IE = 1;
+
+  INTCONbits.PEIE = 1;
+  mEnableInterrupt();
 }
 
-/** Read and process 24 bits of code.
+/** Start clocking in 24 bits of code, at interrupt level. */
+void MITStartFrame(void)
+{
+  INTCON3bits.INT2IE = 0;       // Ignore data line until code is done.
+  INTCON3bits.INT2IF = 0;
+
+  mitBit = 0;
+  tkBits[0] = tkBits[1] = tkBits[2] = 0;
+
+  TK_KBDCLK = 0;                // Clock low.
+  TMR2 = 0;
+  PIR1bits.TMR2IF = 0;
+  PIE1bits.TMR2IE = 1;
+  T2CONbits.TMR2ON = 1;
+}
+
+/** Advance the clock half a bit, at interrupt level.
+ * When all 24 bits are in, queue the transition they describe.
  * See MOON;KBD PROTOC for interpretation.
  */
-void ReadMIT(void)
+void MITClockBit(void)
 {
-  int i,j;
+  PIR1bits.TMR2IF = 0;
 
-  for (i = 0; i < 3; i++) {
-    unsigned char code = 0;
-    for (j = 0; j < 8; j++) {
-      TK_KBDCLK = 0;            // Clock low.
-      Delay100TCYx(4);          // 400 cycles @ 20MHz = 50kHz.
-      if (TK_KBDIN) {
-        code |= (1 << j);
-      }
-      TK_KBDCLK = 1;            // Clock high (idle).
-      Delay100TCYx(4);
+  if (!TK_KBDCLK) {
+    if (TK_KBDIN) {
+      tkBits[mitBit >> 3] |= (1 << (mitBit & 7));
     }
-    tkBits[i] = code;
+    TK_KBDCLK = 1;              // Clock high (idle).
+    mitBit++;
+    return;
   }
+
+  if (mitBit < 24) {
+    TK_KBDCLK = 0;              // Clock low.
+    return;
+  }
+
+  T2CONbits.TMR2ON = 0;
+  PIE1bits.TMR2IE = 0;
+  Reads++;
+
   switch (tkBits[2]) {
   case 0xF9:
     switch (tkBits[1] & 0xC0) {
     case 0:
-      if (tkBits[1] & 0x01)
-        KeyUp(&SpaceCadetKeys[tkBits[0]]);
-      else
-        KeyDown(&SpaceCadetKeys[tkBits[0]]);
+      PutKeyEvent((tkBits[1] & 0x01) ? KEY_UP : KEY_DOWN, tkBits[0], 0);
       break;
     case 0x80:
-      SpaceCadetAllKeysUp(tkBits[0] | (((unsigned short)tkBits[1] & 0x07) << 8));
+      PutKeyEvent(ALL_KEYS_UP, 0, 
+                  tkBits[0] | (((unsigned short)tkBits[1] & 0x07) << 8));
+      break;
+    default:
+      MITUnknownFrames++;
       break;
     }
     break;
   case 0xFF:
-    TKShiftKeys((tkBits[0] & 0xC0) | ((unsigned short)tkBits[1] << 8));
-    NKeysDown = 0;              // There are no up transitions.
-    KeyDown(&TKKeys[tkBits[0] & 0x3F]);
+    PutKeyEvent(TK_KEY_DOWN, tkBits[0] & 0x3F,
+                (tkBits[0] & 0xC0) | ((unsigned short)tkBits[1] << 8));
+    break;
+  default:
+    MITUnknownFrames++;
     break;
   }
+
+  if (mKeyEventsFull()) {
+    MITHeld = TRUE;             // UserTasks starts the next when there's room.
+    return;
+  }
+  INTCON3bits.INT2IF = !TK_KBDIN; // Already low: next code follows at once.
+  INTCON3bits.INT2IE = 1;
 }
 
 #pragma udata
 
-rom KeyInfo ExplorerKeys[128] = {
-  NO_KEY(000),
-  LISP_KEY(001, 0x75, NULL),    // HELP
-  NO_KEY(002),
-  SHIFT_KEY(003, 0x39, CAPS_LOCK), // CAPS-LOCK
-  LISP_KEY(004, 0xEE, "boldlock"), // BOLD-LOCK (shift key? LED?)
-  LISP_KEY(005, 0xEF, "itallock"), // ITAL-LOCK (shift key? LED?)
-  SHIFT_KEY(006, 0x47, MODE_LOCK), // MODE-LOCK
-  SHIFT_KEY(007, 0xE8, L_HYPER), // LEFT-HYPER
-  LISP_KEY(010, 0x65, "system"), // SYSTEM
-  LISP_KEY(011, 0x76, "network"), // NETWORK
-  LISP_KEY(012, 0x9A, "status"), // STATUS
-  LISP_KEY(013, 0xA1, "terminal"), // TERMINAL
-  NO_KEY(014),
-  LISP_KEY(015, 0xA2, "clearscreen"), // CLEAR-SCREEN
-  LISP_KEY(016, 0x9C, "clearinput"), // CLEAR-INPUT
-  LISP_KEY(017, 0x7A, "undo"),  // UNDO
-  PC_KEY(020, 0x4D, NULL),      // END
-  LISP_KEY(021, 0x42, "left"),  // LEFT (mouse keys? like i ii iii?)
-  LISP_KEY(022, 0x43, "middle"), // MIDDLE
-  LISP_KEY(023, 0x44, "right"), // RIGHT
-  PC_KEY(024, 0x3A, NULL),      // F1
-  PC_KEY(025, 0x3B, NULL),      // F2
-  PC_KEY(026, 0x3C, NULL),      // F3
-  PC_KEY(027, 0x3D, NULL),      // F4
-  NO_KEY(030),
-  NO_KEY(031),
-  SHIFT_KEY(032, 0xE3, L_SUPER), // LEFT-SUPER
-  SHIFT_KEY(033, 0xE2, L_META), // LEFT-META
-  SHIFT_KEY(034, 0xE0, L_CONTROL), // LEFT-CONTROL
-  SHIFT_KEY(035, 0xE4, R_CONTROL), // RIGHT-CONTROL
-  SHIFT_KEY(036, 0xE6, R_META), // RIGHT-META
-  SHIFT_KEY(037, 0xE7, R_SUPER), // RIGHT-SUPER
-  SHIFT_KEY(040, 0xE9, R_HYPER), // RIGHT-HYPER
-  LISP_KEY(041, 0x9E, "resume"), // RESUME
-  NO_KEY(042),
-  LISP_KEY(043, 0x29, "escape"), // ALT (ESCAPE actually?)
-  PC_KEY(044, 0x1E, NULL),      // 1
-  PC_KEY(045, 0x1F, NULL),      // 2
-  PC_KEY(046, 0x20, NULL),      // 3
-  PC_KEY(047, 0x21, NULL),      // 4
-  PC_KEY(050, 0x22, NULL),      // 5
-  PC_KEY(051, 0x23, NULL),      // 6
-  PC_KEY(052, 0x24, NULL),      // 7
-  PC_KEY(053, 0x25, NULL),      // 8
-  PC_KEY(054, 0x26, NULL),      // 9
-  PC_KEY(055, 0x27, NULL),      // 0
-  PC_KEY(056, 0x2D, NULL),      // MINUS
-  PC_KEY(057, 0x2E, NULL),      // EQUALS
-  PC_KEY(060, 0xB8, NULL),      // BACK-QUOTE (` {)
-  PC_KEY(061, 0xB9, NULL),      // TILDE (~ })
-  PC_KEY(062, 0x67, NULL),      // KEYPAD-EQUAL
-  PC_KEY(063, 0x57, NULL),      // KEYPAD-PLUS
-  PC_KEY(064, 0xCD, NULL),      // KEYPAD-SPACE
-  PC_KEY(065, 0xBA, NULL),      // KEYPAD-TAB
-  LISP_KEY(066, 0x9B, "break"),  // BREAK
-  NO_KEY(067),
-  PC_KEY(070, 0x2B, NULL),      // TAB
-  PC_KEY(071, 0x14, NULL),      // Q
-  PC_KEY(072, 0x1A, NULL),      // W
-  PC_KEY(073, 0x08, NULL),      // E
-  PC_KEY(074, 0x15, NULL),      // R
-  PC_KEY(075, 0x17, NULL),      // T
-  PC_KEY(076, 0x1C, NULL),      // Y
-  PC_KEY(077, 0x18, NULL),      // U
-  PC_KEY(100, 0x0C, NULL),      // I
-  PC_KEY(101, 0x12, NULL),      // O
-  PC_KEY(102, 0x13, NULL),      // P
-  LISP_KEY(103, 0xB6, "parenleft,bracketleft"), // OPEN-PARENTHESIS
-  LISP_KEY(104, 0xB7, "parenright,bracketleft"), // CLOSE-PARENTHESIS
-  NO_KEY(105),
-  PC_KEY(106, 0x31, NULL),      // BACKSLASH
-  PC_KEY(107, 0x52, NULL),      // UP-ARROW
-  PC_KEY(110, 0x5F, NULL),      // KEYPAD-7
-  PC_KEY(111, 0x60, NULL),      // KEYPAD-8
-  PC_KEY(112, 0x61, NULL),      // KEYPAD-9
-  PC_KEY(113, 0x56, NULL),      // KEYPAD-MINUS
-  LISP_KEY(114, 0x78, "abort"), // ABORT
-  NO_KEY(115),
-  NO_KEY(116),
-  PC_KEY(117, 0x2A, NULL),      // RUBOUT
-  PC_KEY(120, 0x04, NULL),      // A
-  PC_KEY(121, 0x16, NULL),      // S
-  PC_KEY(122, 0x07, NULL),      // D
-  PC_KEY(123, 0x09, NULL),      // F
-  PC_KEY(124, 0x0A, NULL),      // G
-  PC_KEY(125, 0x0B, NULL),      // H
-  PC_KEY(126, 0x0D, NULL),      // J
-  PC_KEY(127, 0x0E, NULL),      // K
-  PC_KEY(130, 0x0F, NULL),      // L
-  PC_KEY(131, 0x33, NULL),      // SEMICOLON
-  PC_KEY(132, 0x34, NULL),      // APOSTROPHE
-  PC_KEY(133, 0x28, NULL),      // RETURN
-  LISP_KEY(134, 0xA5, "line"),  // LINE (others use keypad enter)
-  PC_KEY(135, 0x50, NULL),      // LEFT-ARROW
-  PC_KEY(136, 0x4A, NULL),      // HOME
-  PC_KEY(137, 0x4F, NULL),      // RIGHT-ARROW
-  PC_KEY(140, 0x5C, NULL),      // KEYPAD-4
-  PC_KEY(141, 0x5D, NULL),      // KEYPAD-5
-  PC_KEY(142, 0x5E, NULL),      // KEYPAD-6
-  PC_KEY(143, 0x85, NULL),      // KEYPAD-COMMA
-  NO_KEY(144),
-  NO_KEY(145),
-  SHIFT_KEY(146, 0xEA, L_SYMBOL), // LEFT-SYMBOL
-  SHIFT_KEY(147, 0xE1, L_SHIFT), // LEFT-SHIFT
-  PC_KEY(150, 0x1D, NULL),      // Z
-  PC_KEY(151, 0x1B, NULL),      // X
-  PC_KEY(152, 0x06, NULL),      // C
-  PC_KEY(153, 0x19, NULL),      // V
-  PC_KEY(154, 0x05, NULL),      // B
-  PC_KEY(155, 0x11, NULL),      // N
-  PC_KEY(156, 0x10, NULL),      // M
-  PC_KEY(157, 0x36, NULL),      // COMMA
-  PC_KEY(160, 0x37, NULL),      // PERIOD
-  PC_KEY(161, 0x38, NULL),      // QUESTION
-  SHIFT_KEY(162, 0xE5, R_SHIFT), // RIGHT-SHIFT
-  NO_KEY(163),
-  SHIFT_KEY(164, 0xEB, R_SYMBOL), // RIGHT-SYMBOL
-  PC_KEY(165, 0x51, NULL),      // DOWN-ARROW
-  PC_KEY(166, 0x59, NULL),      // KEYPAD-1
-  PC_KEY(167, 0x5A, NULL),      // KEYPAD-2
-  PC_KEY(170, 0x5B, NULL),      // KEYPAD-3
-  NO_KEY(171),
-  NO_KEY(172),
-  PC_KEY(173, 0x2C, NULL),      // SPACE
-  NO_KEY(174),
-  PC_KEY(175, 0x62, NULL),      // KEYPAD-0
-  PC_KEY(176, 0x63, NULL),      // KEYPAD-PERIOD
-  PC_KEY(177, 0x58, NULL)       // KEYPAD-ENTER
-};
+unsigned short tiOverruns, tiFramingErrors;
 
 #pragma code
 
 void InitTI(void)
 {
+  TRISCbits.TRISC7 = 1;         // RX.
+
+  // EUSART asynchronous receive only, 16-bit baud rate generator.
+  TXSTA = 0x04;                 // BRGH.
+  BAUDCONbits.BRG16 = 1;
+  SPBRGH = TI_SPBRG >> 8;
+  SPBRG = TI_SPBRG & 0xFF;
+  RCSTA = 0x90;                 // SPEN, CREN.
+
+  tiOverruns = tiFramingErrors = 0;
+
+  PIR1bits.RCIF = 0;
+  PIE1bits.RCIE = 1;
+  INTCONbits.PEIE = 1;
+  mEnableInterrupt();
 }
 
-void ReadTI(void)
+/** Take received scan codes, at interrupt level, so that RCREG's two
+ * byte FIFO is never overrun however fast the typing.  Each code is
+ * the key with 0x80 set for down.
+ */
+void TIReceive(void)
 {
-  char scan;
+  unsigned char scan;
 
-  // TODO: Actually read from the hardware somehow.  UART?
-  scan = 0;
-  
-  if (scan & 0x80)
-    KeyDown(&ExplorerKeys[scan & 0x7F]);
-  else
-    KeyUp(&ExplorerKeys[scan]);
+  while (PIR1bits.RCIF) {
+    if (RCSTAbits.FERR) {
+      scan = RCREG;             // Discard; reading clears FERR.
+      tiFramingErrors++;
+      continue;
+    }
+    scan = RCREG;
+    Reads++;
+    PutKeyEvent((scan & 0x80) ? KEY_DOWN : KEY_UP, scan & 0x7F, 0);
+  }
+
+  if (RCSTAbits.OERR) {
+    tiOverruns++;
+    RCSTAbits.CREN = 0;         // Only way to clear it.
+    RCSTAbits.CREN = 1;
+  }
 }
 
 #pragma udata
 
 unsigned char smbxKeyStates[16], smbxNKeyStates[16];
 
-rom KeyInfo SMBXKeyInfos[128] = {
-  NO_KEY(000),
-  NO_KEY(001),
-  LISP_KEY(002, 0xA1, "local"), /* local | oper */
-  SHIFT_KEY(003, 0x82, CAPS_LOCK), /* caps lock | locking caps lock */
-  SHIFT_KEY(004, 0xE8, L_HYPER), /* left hyper */
-  SHIFT_KEY(005, 0xE2, L_META), /* left meta | left alt */
-  SHIFT_KEY(006, 0xE4, R_CONTROL), /* right control */
-  SHIFT_KEY(007, 0xE7, R_SUPER), /* right super | right gui */
-  LISP_KEY(010, 0x4E, "scroll"), /* scroll | page down */
-  SHIFT_KEY(011, 0x84, MODE_LOCK), /* mode lock | locking scroll lock */
-  NO_KEY(012),
-  NO_KEY(013),
-  NO_KEY(014),
-  LISP_KEY(015, 0x65, "select"), /* select | application */
-  SHIFT_KEY(016, 0xEA, L_SYMBOL), /* left symbol */
-  SHIFT_KEY(017, 0xE3, L_SUPER), /* left super | left gui */
-  SHIFT_KEY(020, 0xE0, L_CONTROL), /* left control */
-  PC_KEY(021, 0x2C, NULL),      /* space */
-  SHIFT_KEY(022, 0xE6, R_META), /* right meta | right alt */
-  SHIFT_KEY(023, 0xE9, R_HYPER), /* right hyper */
-  PC_KEY(024, 0x4D, NULL),      /* end */
-  NO_KEY(025),
-  NO_KEY(026),
-  NO_KEY(027),
-  PC_KEY(030, 0x1D, NULL),      /* z */
-  PC_KEY(031, 0x06, NULL),      /* c */
-  PC_KEY(032, 0x05, NULL),      /* b */
-  PC_KEY(033, 0x10, NULL),      /* m */
-  PC_KEY(034, 0x37, NULL),      /* . */
-  SHIFT_KEY(035, 0xE5, R_SHIFT), /* right shift */
-  SHIFT_KEY(036, 0xEE, REPEAT), /* repeat */
-  LISP_KEY(037, 0x78, "abort"), /* abort | stop */
-  NO_KEY(040),
-  NO_KEY(041),
-  NO_KEY(042),
-  SHIFT_KEY(043, 0xE1, L_SHIFT), /* left shift */
-  PC_KEY(044, 0x1B, NULL),      /* x */
-  PC_KEY(045, 0x19, NULL),      /* v */
-  PC_KEY(046, 0x11, NULL),      /* n */
-  PC_KEY(047, 0x36, NULL),      /* , */
-  PC_KEY(050, 0x38, NULL),      /* / */
-  SHIFT_KEY(051, 0xEB, R_SYMBOL), /* right symbol */
-  LISP_KEY(052, 0x75, "help"),  /* help */
-  NO_KEY(053),
-  NO_KEY(054),
-  NO_KEY(055),
-  PC_KEY(056, 0x2A, NULL),      /* rubout | delete (backspace) */
-  PC_KEY(057, 0x16, NULL),      /* s */
-  PC_KEY(060, 0x09, NULL),      /* f */
-  PC_KEY(061, 0x0B, NULL),      /* h */
-  PC_KEY(062, 0x0E, NULL),      /* k */
-  PC_KEY(063, 0x33, NULL),      /* ; */
-  PC_KEY(064, 0x28, NULL),      /* return | enter */
-  LISP_KEY(065, 0xA4, "complete"), /* complete | exsel */
-  NO_KEY(066),
-  NO_KEY(067),
-  NO_KEY(070),
-  LISP_KEY(071, 0x76, "network"), /* network | menu */
-  PC_KEY(072, 0x04, NULL),      /* a */
-  PC_KEY(073, 0x07, NULL),      /* d */
-  PC_KEY(074, 0x0A, NULL),      /* g */
-  PC_KEY(075, 0x0D, NULL),      /* j */
-  PC_KEY(076, 0x0F, NULL),      /* l */
-  PC_KEY(077, 0x34, NULL),      /* ' */
-  LISP_KEY(100, 0x58, "line"),  /* line | keypad enter */
-  NO_KEY(101),
-  NO_KEY(102),
-  NO_KEY(103),
-  LISP_KEY(104, 0x79, "function"), /* function | again */
-  PC_KEY(105, 0x1A, NULL),      /* w */
-  PC_KEY(106, 0x15, NULL),      /* r */
-  PC_KEY(107, 0x1C, NULL),      /* y */
-  PC_KEY(110, 0x0C, NULL),      /* i */
-  PC_KEY(111, 0x13, NULL),      /* p */
-  LISP_KEY(112, 0xB7, "parenright"), /* ) | keypad ) */
-  LISP_KEY(113, 0x9F, "page"),  /* page | keypad separator */
-  NO_KEY(114),
-  NO_KEY(115),
-  NO_KEY(116),
-  PC_KEY(117, 0x2B, NULL),      /* tab */
-  PC_KEY(120, 0x14, NULL),      /* q */
-  PC_KEY(121, 0x08, NULL),      /* e */
-  PC_KEY(122, 0x17, NULL),      /* t */
-  PC_KEY(123, 0x18, NULL),      /* u */
-  PC_KEY(124, 0x12, NULL),      /* o */
-  LISP_KEY(125, 0xB6, "parenleft"), /* ( | keypad ( */
-  PC_KEY(126, 0x49, NULL),      /* backspace | insert */
-  NO_KEY(127),
-  NO_KEY(130),
-  NO_KEY(131),
-  LISP_KEY(132, 0xCB, "colon"), /* : | keypad : */
-  PC_KEY(133, 0x1F, NULL),      /* 2 */
-  PC_KEY(134, 0x21, NULL),      /* 4 */
-  PC_KEY(135, 0x23, NULL),      /* 6 */
-  PC_KEY(136, 0x25, NULL),      /* 8 */
-  PC_KEY(137, 0x27, NULL),      /* 0 */
-  PC_KEY(140, 0x2E, NULL),      /* = */
-  PC_KEY(141, 0x31, NULL),      /* \ */
-  NO_KEY(142),
-  NO_KEY(143),
-  NO_KEY(144),
-  PC_KEY(145, 0x1E, NULL),      /* 1 */
-  PC_KEY(146, 0x20, NULL),      /* 3 */
-  PC_KEY(147, 0x22, NULL),      /* 5 */
-  PC_KEY(150, 0x24, NULL),      /* 7 */
-  PC_KEY(151, 0x26, NULL),      /* 9 */
-  PC_KEY(152, 0x2D, NULL),      /* - */
-  PC_KEY(153, 0x35, NULL),      /* ` */
-  LISP_KEY(154, 0xC9, "vertbar"), /* | | keypad | */
-  NO_KEY(155),
-  NO_KEY(156),
-  NO_KEY(157),
-  LISP_KEY(160, 0x29, "escape"), /* escape */
-  LISP_KEY(161, 0xA2, "refresh"), /* refresh | clear / again */
-  LISP_KEY(162, 0x42, "square"), /* square | F9 */
-  LISP_KEY(163, 0x43, "circle"), /* circle | F10 */
-  LISP_KEY(164, 0x44, "triangle"), /* triangle | F11 */
-  LISP_KEY(165, 0x9C, "clearinput"), /* clear input | clear */
-  LISP_KEY(166, 0x9B, "suspend"), /* suspend | cancel */
-  LISP_KEY(167, 0x9E, "resume"), /* resume | return */
-  NO_KEY(170),
-  NO_KEY(171),
-  NO_KEY(172),
-  NO_KEY(173),
-  NO_KEY(174),
-  NO_KEY(175),
-  NO_KEY(176),
-  NO_KEY(177)
-};
-
 #pragma code
 
 void InitSMBX(void)
@@ -1179,12 +1313,43 @@ void InitSMBX(void)
 
   for (i = 0; i < 16; i++)
     smbxKeyStates[i] = 0;
+  DebounceInit();
+
+  // Timer1 at 1:8 prescale with 16-bit reads, reset by CCP1 compare.
+  TMR1H = 0;
+  TMR1L = 0;
+  T1CON = 0xB0;
+  CCP1CON = 0x0B;               // Compare, special event trigger.
+  PIR1bits.CCP1IF = 0;
+  PIE1bits.CCP1IE = 1;
+  T1CONbits.TMR1ON = 1;
+
+  INTCONbits.PEIE = 1;
+  mEnableInterrupt();
+}
+
+/** Start a scan at interrupt level, once each scan period. */
+void SMBXTick(void)
+{
+  unsigned short late;
+
+  PIR1bits.CCP1IF = 0;
+
+  late = TMR1L;                 // Latches TMR1H.
+  late |= (unsigned short)TMR1H << 8;
+  if (late > 0xFF)
+    late = 0xFF;
+  if ((unsigned char)late > hid_report_feature[3])
+    hid_report_feature[3] = (unsigned char)late;
+
+  ScanSMBX();
 }
 
 void ScanSMBX(void)
 {
   int i,j;
 
+  Reads++;
   SMBX_KBDSCAN = 0;
   SMBX_KBDSCAN = 1;
   for (i = 0; i < 16; i++) {
@@ -1202,19 +1367,177 @@ void ScanSMBX(void)
   for (i = 0; i < 16; i++) {
     unsigned char keys, change;
     keys = smbxNKeyStates[i];
-    change = keys ^ smbxKeyStates[i];
+    // Only first edges: bounces within the window are dropped.
+    change = DebounceEdges(i, keys, smbxKeyStates[i]);
     if (change == 0) continue;
-    smbxKeyStates[i] = keys;
     for (j = 0; j < 8; j++) {
       if (change & (1 << j)) {
         int code = (i * 8) + j;
-        if (keys & (1 << j)) {
-          KeyDown(&SMBXKeyInfos[code]);
-        }
-        else {
-          KeyUp(&SMBXKeyInfos[code]);
-        }
+        if (!PutKeyEvent((keys & (1 << j)) ? KEY_DOWN : KEY_UP, code, 0))
+          change &= ~(1 << j);  // No room: pick it up again next scan.
       }
     }    
+    smbxKeyStates[i] ^= change;
+    DebounceAccept(i, change);
+  }
+}
+
+// Set the SMBX scan period, in ms, within what Timer1 can count.
+// The feature report is updated with the period actually used.
+void SetScanPeriod(unsigned char period)
+{
+  unsigned short counts;
+  unsigned char running;
+
+  if (period == 0)
+    period = 1;
+  else if (period > SCAN_PERIOD_MAX)
+    period = SCAN_PERIOD_MAX;
+  CurrentScanPeriod = period;
+  hid_report_feature[2] = period;
+
+  counts = (unsigned short)period * SCAN_COUNTS_PER_MS;
+  // Stop Timer1 while the compare is half written, and start the new
+  // period from zero, lest the count already be past it and have to
+  // wrap all the way around.
+  running = T1CONbits.TMR1ON;
+  T1CONbits.TMR1ON = 0;
+  CCPR1H = counts >> 8;
+  CCPR1L = counts & 0xFF;
+  TMR1H = 0;                    // Buffered until TMR1L is written.
+  TMR1L = 0;
+  T1CONbits.TMR1ON = running;
+
+  SetDebounceWindow(CurrentDebounceMS); // Counted in scans.
+}
+
+// Set the debounce window, in ms, rounded up to whole scans, as many
+// as the debounce counters hold.
+void SetDebounceWindow(unsigned char ms)
+{
+  unsigned short scans;
+
+  // In 16 bits: C18 does not promote, and ms from the host can be
+  // near 255.
+  scans = ((unsigned short)ms + CurrentScanPeriod - 1) / CurrentScanPeriod;
+  if (scans > DEBOUNCE_SCANS_MAX) {
+    scans = DEBOUNCE_SCANS_MAX;
+    ms = scans * CurrentScanPeriod;
+  }
+  CurrentDebounceMS = ms;
+  hid_report_feature[4] = ms;
+  DebounceSetWindow(scans);
+}
+
+// Set the repeat delay, in 10 ms units, 0 for none, and the interval
+// between repeats, in ms.
+void SetRepeat(unsigned char delay, unsigned char interval)
+{
+  if (interval == 0)
+    interval = 1;
+  CurrentRepeatDelay = delay;
+  CurrentRepeatInterval = interval;
+  hid_report_feature[5] = delay;
+  hid_report_feature[6] = interval;
+
+  RepeatDelayCounts = (unsigned long)delay * (PERF_COUNTS_PER_SECOND / 100);
+  RepeatIntervalCounts = (unsigned long)interval * PERF_COUNTS_PER_SECOND / 1000;
+  RepeatWait = RepeatDelayCounts;
+}
+
+/**** Performance counters ****/
+
+void InitPerf(void)
+{
+  int i;
+
+  T0CON = 0x85;                 // On, 16-bit, 1:64 prescale.
+  PerfLastTime = TMR0L;         // Latches TMR0H.
+  PerfLastTime |= (unsigned short)TMR0H << 8;
+  PerfTime = 0;
+  LoopsCounted = WorstLoopTime = 0;
+  Reads = MITUnknownFrames = 0;
+  KeyEventsProcessed = ReportsSent = EmacsQueueFull = 0;
+  EmacsHighWater = 0;
+
+  for (i = 0; i < HID_VND_FEATURE_SIZE; i++)
+    hid_vnd_report_feature[i] = 0;
+  hid_vnd_report_feature[0] = HID_VND_PERF_RPT_ID;
+}
+
+// Time one pass of the main loop, and once a second update the report.
+void CountLoop(void)
+{
+  unsigned short now, elapsed;
+  byte gie;
+
+  gie = INTCONbits.GIE;
+  INTCONbits.GIE = 0;           // TMR0H latch is shared with PutKeyEvent.
+  now = TMR0L;
+  now |= (unsigned short)TMR0H << 8;
+  INTCONbits.GIE = gie;
+  elapsed = now - PerfLastTime;
+  PerfLastTime = now;
+  LoopElapsed = elapsed;
+
+  if (elapsed > WorstLoopTime)
+    WorstLoopTime = elapsed;
+  if (LoopsCounted < 0xFFFF)
+    LoopsCounted++;
+
+  PerfTime += elapsed;
+  if (PerfTime >= PERF_COUNTS_PER_SECOND) {
+    PerfTime -= PERF_COUNTS_PER_SECOND;
+    SnapshotPerf();
+    LoopsCounted = WorstLoopTime = 0;
   }
 }
+
+void SnapshotPerf(void)
+{
+  PerfReport report;
+  byte gie;
+  unsigned char i;
+
+  report.loopsPerSecond = LoopsCounted;
+  report.worstLoopTime = WorstLoopTime;
+  report.keyEvents = KeyEventsProcessed;
+  report.reportsSent = ReportsSent;
+  report.reportsDeferred = KeyReportsDeferred;
+  report.reportsCoalesced = KeyReportsCoalesced;
+  report.emacsQueueFull = EmacsQueueFull;
+  report.emacsHighWater = EmacsHighWater;
+
+  gie = INTCONbits.GIE;
+  INTCONbits.GIE = 0;           // These are counted at interrupt level.
+  report.reads = Reads;
+  report.keyEventsDropped = KeyEventOverflows;
+  report.mitUnknownFrames = MITUnknownFrames;
+  report.tiErrors = tiOverruns + tiFramingErrors;
+  INTCONbits.GIE = gie;
+  report.reportsSuppressed = ReportsSuppressed;
+
+  hid_vnd_report_feature[0] = HID_VND_PERF_RPT_ID;
+  i = PutPerfShort(1, report.loopsPerSecond);
+  i = PutPerfShort(i, report.worstLoopTime);
+  i = PutPerfShort(i, report.reads);
+  i = PutPerfShort(i, report.keyEvents);
+  i = PutPerfShort(i, report.keyEventsDropped);
+  i = PutPerfShort(i, report.reportsSent);
+  i = PutPerfShort(i, report.reportsDeferred);
+  i = PutPerfShort(i, report.reportsCoalesced);
+  i = PutPerfShort(i, report.emacsQueueFull);
+  hid_vnd_report_feature[i++] = report.emacsHighWater;
+  i = PutPerfShort(i, report.mitUnknownFrames);
+  i = PutPerfShort(i, report.tiErrors);
+  PutPerfShort(i, report.reportsSuppressed);
+}
+
+// Store a short into the perf report at i, returning where the next
+// field goes.
+unsigned char PutPerfShort(unsigned char i, unsigned short value)
+{
+  hid_vnd_report_feature[i++] = value & 0xFF;
+  hid_vnd_report_feature[i++] = value >> 8;
+  return i;
+}
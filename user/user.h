@@ -5,5 +5,10 @@
 
 void UserInit(void);
 void UserTasks(void);
+void UserInterrupt(void);
+
+// Keyboard reports held for a busy endpoint, and those replaced by a
+// later state before they could go.
+extern unsigned short KeyReportsDeferred, KeyReportsCoalesced;
 
 #endif //USER_H
@@ -0,0 +1,103 @@
+// Dump the LispM keyboard's performance counters.
+//
+// They are a feature report on the vendor interface, read through its
+// hidraw device, so the keyboard stays in use while this runs.
+//
+//   cc -o lmkbdperf lmkbdperf.c
+//   ./lmkbdperf [/dev/hidrawN [seconds]]
+//
+// With an interval, keeps printing, with the change in the running
+// totals since the last time.
+
+#include <linux/hidraw.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PERF_REPORT_ID 0x02
+#define PERF_REPORT_SIZE 26
+
+// Timer0 counts, at 48MHz / 4 / 64.
+#define TIMER0_US (64.0 / 12.0)
+
+// Running totals, as laid out in the report after the two loop figures.
+static const struct {
+  const char *name;
+  int offset;
+  int size;
+} Totals[] = {
+  { "reads", 5, 2 },
+  { "key events", 7, 2 },
+  { "key events dropped", 9, 2 },
+  { "reports sent", 11, 2 },
+  { "reports deferred", 13, 2 },
+  { "reports coalesced", 15, 2 },
+  { "Emacs queue held", 17, 2 },
+  { "Emacs queue high water", 19, 1 },
+  { "MIT unknown frames", 20, 2 },
+  { "TI receive errors", 22, 2 },
+  { "reports suppressed", 24, 2 },
+};
+#define N_TOTALS (sizeof(Totals) / sizeof(Totals[0]))
+
+static unsigned Field(const unsigned char *report, int offset, int size)
+{
+  if (size == 1)
+    return report[offset];
+  return report[offset] | (report[offset + 1] << 8);
+}
+
+static int GetReport(int fd, unsigned char *report)
+{
+  memset(report, 0, PERF_REPORT_SIZE);
+  report[0] = PERF_REPORT_ID;
+  if (ioctl(fd, HIDIOCGFEATURE(PERF_REPORT_SIZE), report) < 0) {
+    perror("HIDIOCGFEATURE");
+    return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  const char *device = "/dev/hidraw1";
+  int interval = 0;
+  unsigned char report[PERF_REPORT_SIZE], last[PERF_REPORT_SIZE];
+  int fd, i, first;
+
+  if (argc > 1)
+    device = argv[1];
+  if (argc > 2)
+    interval = atoi(argv[2]);
+
+  fd = open(device, O_RDONLY);
+  if (fd < 0) {
+    perror(device);
+    return 1;
+  }
+
+  for (first = 1; ; first = 0) {
+    if (GetReport(fd, report) < 0)
+      return 1;
+    printf("loops/second           %u\n", Field(report, 1, 2));
+    printf("worst loop             %.0f us\n", Field(report, 3, 2) * TIMER0_US);
+    for (i = 0; i < N_TOTALS; i++) {
+      unsigned value = Field(report, Totals[i].offset, Totals[i].size);
+      printf("%-22s %u", Totals[i].name, value);
+      if (!first && (Totals[i].size == 2))
+        printf(" (+%u)", (value - Field(last, Totals[i].offset, 2)) & 0xFFFF);
+      printf("\n");
+    }
+    if (interval <= 0)
+      break;
+    memcpy(last, report, sizeof(last));
+    printf("\n");
+    sleep(interval);
+  }
+
+  close(fd);
+  return 0;
+}
@@ -1,8 +1,11 @@
-
 #include "lmkbdusb.h"
-#include <usb.h>
+#include <libusb-1.0/libusb.h>
+#include <pthread.h>
+#include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
 
 #define HID_REPORT_GET 0x01
 #define HID_REPORT_SET 0x09
@@ -13,421 +16,524 @@
 
 #define USB_TIMEOUT 10000
 
-// Indexed by HUT page 7 usage id, give the original key codes for
-// each keyboards.
-static unsigned char KeyMappings[256][4] = {
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 00 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 01 ErrorRollOver */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 02 POSTF */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 03 ErrorUndefined */
-  { 0047, 0123, 0120, 0072 },   /* 04 A */
-  { 0071, 0114, 0154, 0032 },   /* 05 B */
-  { 0067, 0164, 0152, 0031 },   /* 06 C */
-  { 0051, 0163, 0122, 0073 },   /* 07 D */
-  { 0026, 0162, 0073, 0121 },   /* 08 E */
-  { 0052, 0013, 0123, 0060 },   /* 09 F */
-  { 0053, 0113, 0124, 0074 },   /* 0A G */
-  { 0054, 0053, 0125, 0061 },   /* 0B H */
-  { 0033, 0032, 0100, 0110 },   /* 0C I */
-  { 0055, 0153, 0126, 0075 },   /* 0D J */
-  { 0056, 0033, 0127, 0062 },   /* 0E K */
-  { 0057, 0073, 0130, 0076 },   /* 0F L */
-  { 0073, 0154, 0156, 0033 },   /* 10 M */
-  { 0072, 0054, 0155, 0046 },   /* 11 N */
-  { 0034, 0072, 0101, 0124 },   /* 12 O */
-  { 0035, 0172, 0102, 0111 },   /* 13 P */
-  { 0024, 0122, 0071, 0120 },   /* 14 Q */
-  { 0027, 0012, 0074, 0106 },   /* 15 R */
-  { 0050, 0063, 0121, 0057 },   /* 16 S */
-  { 0030, 0112, 0075, 0122 },   /* 17 T */
-  { 0032, 0152, 0077, 0123 },   /* 18 U */
-  { 0070, 0014, 0153, 0045 },   /* 19 V */
-  { 0025, 0062, 0072, 0105 },   /* 1A W */
-  { 0066, 0064, 0151, 0044 },   /* 1B X */
-  { 0031, 0052, 0076, 0107 },   /* 1C Y */
-  { 0065, 0124, 0150, 0030 },   /* 1D Z */
-  { 0002, 0121, 0044, 0145 },   /* 1E 1 */
-  { 0003, 0061, 0045, 0133 },   /* 1F 2 */
-  { 0004, 0161, 0046, 0146 },   /* 20 3 */
-  { 0005, 0011, 0047, 0134 },   /* 21 4 */
-  { 0006, 0111, 0050, 0147 },   /* 22 5 */
-  { 0007, 0051, 0051, 0135 },   /* 23 6 */
-  { 0010, 0151, 0052, 0150 },   /* 24 7 */
-  { 0011, 0031, 0053, 0136 },   /* 25 8 */
-  { 0012, 0071, 0054, 0151 },   /* 26 9 */
-  { 0013, 0171, 0055, 0137 },   /* 27 0 */
-  { 0062, 0136, 0133, 0064 },   /* 28 return (enter) */
-  { 0023, 0143, 0043, 0160 },   /* 29 escape | alt mode */
-  { 0046, 0023, 0117, 0056 },   /* 2A delete (backspace) | rubout */
-  { 0022, 0022, 0070, 0117 },   /* 2B tab */
-  { 0077, 0134, 0173, 0021 },   /* 2C space */
-  { 0xFF, 0131, 0056, 0152 },   /* 2D - _ */
-  { 0014, 0126, 0057, 0140 },   /* 2E = + */
-  { 0036, 0xFF, 0xFF, 0xFF },   /* 2F [ { */
-  { 0037, 0xFF, 0xFF, 0xFF },   /* 30 ] } */
-  { 0040, 0037, 0106, 0141 },   /* 31 \ | */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 32 Non-US # ~ */
-  { 0060, 0173, 0131, 0063 },   /* 33 ; : */
-  { 0xFF, 0133, 0132, 0077 },   /* 34 ' " */
-  { 0xFF, 0077, 0xFF, 0153 },   /* 35 ` ~ */
-  { 0074, 0034, 0157, 0047 },   /* 36 , < */
-  { 0075, 0074, 0160, 0034 },   /* 37 . > */
-  { 0076, 0174, 0161, 0050 },   /* 38 / ? */
-  { 0xFF, 0xFF, 0003, 0xFF },   /* 39 Caps Lock */
-  { 0xFF, 0xFF, 0024, 0xFF },   /* 3A F1 */
-  { 0xFF, 0xFF, 0025, 0xFF },   /* 3B F2 */
-  { 0xFF, 0xFF, 0026, 0xFF },   /* 3C F3 */
-  { 0xFF, 0xFF, 0027, 0xFF },   /* 3D F4 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 3E F5 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 3F F6 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 40 F7 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 41 F8 */
-  { 0xFF, 0101, 0021, 0162 },   /* 42 F9 | I | square */
-  { 0xFF, 0001, 0022, 0163 },   /* 43 F10 | II | circle */
-  { 0xFF, 0102, 0023, 0164 },   /* 44 F11 | III | triangle */
-  { 0xFF, 0002, 0xFF, 0xFF },   /* 45 F12 | IV */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 46 PrintScreen */
-  { 0xFF, 0xFF, 0006, 0xFF },   /* 47 Scroll Lock */
-  { 0xFF, 0170, 0xFF, 0xFF },   /* 48 pause | stop output */
-  { 0017, 0160, 0xFF, 0126 },   /* 49 insert | bs | overstrike | insert */
-  { 0xFF, 0xFF, 0136, 0xFF },   /* 4A Home */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 4B PageUp */
-  { 0xFF, 0157, 0xFF, 0xFF },   /* 4C delete forward | delete */
-  { 0xFF, 0156, 0020, 0024 },   /* 4D end */
-  { 0045, 0xFF, 0xFF, 0010 },   /* 4E page down | vt | scroll */
-  { 0xFF, 0017, 0137, 0xFF },   /* 4F right arrow  | hand right */
-  { 0xFF, 0117, 0135, 0xFF },   /* 50 left arrow | hand left */
-  { 0xFF, 0176, 0165, 0xFF },   /* 51 down arrow | down thumb */
-  { 0xFF, 0106, 0107, 0xFF },   /* 52 up arrow | up thumb */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 53 Keypad Num Lock */
-  { 0041, 0xFF, 0xFF, 0xFF },   /* 54 keypad / | / infinity */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 55 Keypad * */
-  { 0042, 0xFF, 0113, 0xFF },   /* 56 keypad - | circle minus / delta */
-  { 0043, 0xFF, 0063, 0xFF },   /* 57 keypad + | circle plus / del */
-  { 0063, 0036, 0177, 0100 },   /* 58 keypad enter | line */
-  { 0xFF, 0xFF, 0166, 0xFF },   /* 59 Keypad 1 */
-  { 0xFF, 0xFF, 0167, 0xFF },   /* 5A Keypad 2 */
-  { 0xFF, 0xFF, 0170, 0xFF },   /* 5B Keypad 3 */
-  { 0xFF, 0xFF, 0140, 0xFF },   /* 5C Keypad 4 */
-  { 0xFF, 0xFF, 0141, 0xFF },   /* 5D Keypad 5 */
-  { 0xFF, 0xFF, 0142, 0xFF },   /* 5E Keypad 6 */
-  { 0xFF, 0xFF, 0110, 0xFF },   /* 5F Keypad 7 */
-  { 0xFF, 0xFF, 0111, 0xFF },   /* 60 Keypad 8 */
-  { 0xFF, 0xFF, 0112, 0xFF },   /* 61 Keypad 9 */
-  { 0xFF, 0xFF, 0175, 0xFF },   /* 62 Keypad 0 */
-  { 0xFF, 0xFF, 0176, 0xFF },   /* 63 Keypad .*/
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 64 Keypad Non-US \ | */
-  { 0xFF, 0141, 0010, 0015 },   /* 65 application | system | select */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 66 Power */
-  { 0xFF, 0xFF, 0062, 0xFF },   /* 67 Keypad = */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 68 F13 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 69 F14 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 6A F15 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 6B F16 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 6C F17 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 6D F18 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 6E F19 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 6F F20 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 70 F21 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 71 F22 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 72 F23 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 73 F24 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 74 Execute */
-  { 0xFF, 0116, 0001, 0052 },   /* 75 help */
-  { 0xFF, 0042, 0011, 0071 },   /* 76 menu | network */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 77 Select */
-  { 0xFF, 0067, 0114, 0037 },   /* 78 stop | abort */
-  { 0xFF, 0100, 0xFF, 0104 },   /* 79 again | macro | function */
-  { 0xFF, 0xFF, 0017, 0xFF },   /* 7A Undo */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 7B Cut */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 7C Copy */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 7D Paste */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 7E Find */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 7F Mute */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 80 Volume Up */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 81 Volume Down */
-  { 0xFF, 0125, 0xFF, 0003 },   /* 82 locking caps lock */
-  { 0xFF, 0015, 0xFF, 0xFF },   /* 83 locking num lock | alt lock */
-  { 0xFF, 0003, 0xFF, 0011 },   /* 84 locking scroll lock | mode lock */
-  { 0xFF, 0xFF, 0143, 0xFF },   /* 85 Keypad Comma */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 86 Keypad Equal Sign */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 87 International1 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 88 International2 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 89 International3 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 8A International4 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 8B International5 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 8C International6 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 8D International7 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 8E International8 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 8F International9 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 90 LANG1 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 91 LANG2 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 92 LANG3 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 93 LANG4 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 94 LANG5 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 95 LANG6 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 96 LANG7 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 97 LANG8 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 98 LANG9 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* 99 Alternate Erase */
-  { 0xFF, 0046, 0012, 0xFF },   /* 9A sysreq / attention | status */
-  { 0000, 0167, 0066, 0166 },   /* 9B cancel | break | suspend */
-  { 0021, 0110, 0016, 0165 },   /* 9C clear | clear input */
-  { 0064, 0xFF, 0xFF, 0xFF },   /* 9D prior | backnext */
-  { 0xFF, 0047, 0041, 0167 },   /* 9E return | resume */
-  { 0044, 0xFF, 0xFF, 0113 },   /* 9F keypad separator | form | page */
-  { 0020, 0107, 0xFF, 0xFF },   /* A0 out | call  */
-  { 0xFF, 0040, 0013, 0002 },   /* A1 oper | terminal | local */
-  { 0xFF, 0050, 0015, 0161 },   /* A2 clear / again | clear screen | refresh */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* A3 CrSel/Props */
-  { 0xFF, 0120, 0xFF, 0065 },   /* A4 exsel | quote | complete */
-  { 0xFF, 0xFF, 0134, 0xFF },   /* A5 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* A6 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* A7 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* A8 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* A9 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* AA Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* AB Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* AC Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* AD Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* AE Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* AF Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* B0 Keypad 00 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* B1 Keypad 000 */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* B2 Thousands Separator */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* B3 Decimal Separator */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* B4 Currency Unit */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* B5 Currency Sub-unit */
-  { 0xFF, 0132, 0103, 0125 },   /* B6 keypad ( | ( */
-  { 0xFF, 0137, 0104, 0112 },   /* B7 keypad ) | ) */
-  { 0xFF, 0166, 0060, 0xFF },   /* B8 keypad { | { */
-  { 0xFF, 0146, 0061, 0xFF },   /* B9 keypad } | } */
-  { 0xFF, 0xFF, 0065, 0xFF },   /* BA Keypad Tab */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* BB Keypad Backspace */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* BC Keypad A */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* BD Keypad B */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* BE Keypad C */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* BF Keypad D */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* C0 Keypad E */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* C1 Keypad F */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* C2 Keypad XOR */
-  { 0016, 0xFF, 0xFF, 0xFF },   /* C3 keypad ^ | ^ ~ */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* C4 Keypad % */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* C5 Keypad < */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* C6 Keypad > */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* C7 Keypad & */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* C8 Keypad && */
-  { 0xFF, 0xFF, 0xFF, 0154 },   /* C9 keypad | | | */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* CA Keypad || */
-  { 0061, 0021, 0xFF, 0132 },   /* CB keypad : | : */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* CC Keypad # */
-  { 0xFF, 0xFF, 0064, 0xFF },   /* CD Keypad Space */
-  { 0015, 0xFF, 0xFF, 0xFF },   /* CE keypad @ | @ ` */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* CF Keypad ! */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* D0 Keypad Memory Store */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* D1 Keypad Memory Recall */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* D2 Keypad Memory Clear */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* D3 Keypad Memory Add */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* D4 Keypad Memory Subtract */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* D5 Keypad Memory Multiply */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* D6 Keypad Memory Divide */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* D7 Keypad +/- */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* D8 Keypad Clear */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* D9 Keypad Clear Entry */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* DA Keypad Binary */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* DB Keypad Octal */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* DC Keypad Decimal */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* DD Keypad Hexadecimal */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* DE Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* DF Reserved */
-  { 0xFF, 0020, 0034, 0020 },   /* E0 left control */
-  { 0xFF, 0024, 0147, 0043 },   /* E1 left shift */
-  { 0xFF, 0045, 0033, 0005 },   /* E2 left alt | left meta */
-  { 0xFF, 0005, 0032, 0017 },   /* E3 left gui | left super */
-  { 0xFF, 0026, 0035, 0006 },   /* E4 right control */
-  { 0xFF, 0025, 0162, 0035 },   /* E5 right shift */
-  { 0xFF, 0165, 0036, 0022 },   /* E6 right alt | right meta */
-  { 0xFF, 0065, 0037, 0007 },   /* E7 right gui | right super */
-  { 0xFF, 0145, 0007, 0004 },   /* E8 | left hyper */
-  { 0xFF, 0175, 0040, 0023 },   /* E9 | right hyper */
-  { 0xFF, 0104, 0146, 0016 },   /* EA | left top | left symbol */
-  { 0xFF, 0155, 0164, 0051 },   /* EB | right top | right symbol */
-  { 0xFF, 0044, 0xFF, 0xFF },   /* EC | left greek */
-  { 0xFF, 0035, 0xFF, 0xFF },   /* ED | right greek */
-  { 0xFF, 0115, 0004, 0036 },   /* EE | repeat */
-  { 0xFF, 0xFF, 0005, 0xFF },   /* EF Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* F0 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* F1 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* F2 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* F3 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* F4 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* F5 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* F6 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* F7 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* F8 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* F9 Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* FA Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* FB Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* FC Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* FD Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF },   /* FE Reserved */
-  { 0xFF, 0xFF, 0xFF, 0xFF }    /* FF Reserved */
-};
+#define KBD_INTERFACE 0
+#define KBD_ENDPOINT (LIBUSB_ENDPOINT_IN | 1)
+
+// Boot protocol report, or NKRO bitmap under the report protocol.
+#define BOOT_REPORT_SIZE 8
+#define NKRO_REPORT_SIZE 32
+// Either, under the report protocol, can end with a timestamp.
+#define TIMESTAMP_SIZE 2
+
+// Device timestamps are Timer0 counts, at 48MHz / 4 / 64.
+#define TIMESTAMP_HZ 187500
+
+// Latency histograms: 1 ms buckets, the last one for everything longer.
+#define N_LATENCY_BUCKETS 32
+// Samples over which the smallest clock difference is taken.
+#define N_OFFSET_SAMPLES 64
+
+// Interrupt IN transfers kept submitted at once, so that there is
+// always one for the host controller to fill at the next poll,
+// whatever the client is doing.
+#define N_TRANSFERS 4
+// Reports received but not yet made into events.  Another keyboard's
+// reader can complete this one's transfers while its own reader is
+// busy elsewhere, so there is room for a good many.
+#define N_REPORTS 64
+// Events handed to a dispatch handler at once.
+#define N_DISPATCH_EVENTS 32
+// Read timeout for only what is there already.
+#define NO_WAIT -1L
+
+#include "lmkbdkeys.h"
 
 typedef struct {
   unsigned long bits[8];
 } UsageSet;
 
-static BOOL init = FALSE;
-static usb_dev_handle *openHandle = NULL;
-static lmkbd_EventMode openMode;
-static char features[2] = { 0xFF, 0xFF };
-static lmkbd_TranslationMode oldMode = HUT1;
-static UsageSet deviceUsages, clientUsages;
+typedef struct {
+  unsigned char data[NKRO_REPORT_SIZE + TIMESTAMP_SIZE];
+  int len;
+  long long received;           // us
+} Report;
+
+struct lmkbd {
+  lmkbd_t *next;                // In openKeyboards.
+  libusb_device_handle *devh;
+  lmkbd_Location location;
+  lmkbd_EventMode mode;
+  unsigned char features[2];
+  lmkbd_TranslationMode oldMode;
+  int reportSize;               // wMaxPacketSize of the keyboard endpoint.
+
+  // Held by a reader throughout, for the rest of these.
+  pthread_mutex_t readLock;
+  UsageSet deviceUsages, clientUsages;
+  long long reportReceived;     // When the last report arrived, us.
+  BOOL disconnected;            // Unplugged, waiting to come back.
+  BOOL errorReported;           // By lmkbd_Dispatch, which says so once.
+  // The keyboard's clock and ours are unrelated, so key detection to
+  // receipt is measured as the excess over the smallest difference
+  // between them recently seen.  That leaves out the fixed part of
+  // the delay, but tracks drift.
+  unsigned short offsetSamples[N_OFFSET_SAMPLES];
+  int nOffsetSamples, offsetSampleIndex;
+  unsigned long deviceLatency[N_LATENCY_BUCKETS];
+  unsigned long hostLatency[N_LATENCY_BUCKETS];
+
+  // Shared with the transfer callbacks, which run on whichever thread
+  // is handling libusb events.
+  pthread_mutex_t reportLock;
+  struct libusb_transfer *transfers[N_TRANSFERS];
+  unsigned char transferBuffers[N_TRANSFERS][NKRO_REPORT_SIZE + TIMESTAMP_SIZE];
+  int transfersActive;
+  int transferError;            // libusb error that stopped them, or 0.
+  BOOL stopping;
+  Report reports[N_REPORTS];
+  int reportIn, reportOut;
+  unsigned long reportsLost;
+  // A keyboard plugged in where this one was, to be opened by its reader.
+  libusb_device *arrived;
+  // Set when there is something new, for waiting on libusb without
+  // missing a callback that comes first.
+  int reportsReady;
+};
+
+// One libusb context for all keyboards.
+static pthread_once_t initOnce = PTHREAD_ONCE_INIT;
+static libusb_context *context = NULL;
+
+static pthread_mutex_t openLock = PTHREAD_MUTEX_INITIALIZER;
+static lmkbd_t *openKeyboards = NULL;
+
+// For the calls without a handle.
+static lmkbd_t *defaultKeyboard = NULL;
+
+// Whether keyboards unplugged are noticed coming back.
+static BOOL hotplug = FALSE;
+static libusb_hotplug_callback_handle hotplugHandle;
 
 static const uint16_t VENDOR = 0x08DB;
 static const uint16_t PRODUCT = 0x0001;
 
-// Find and claim LispM keyboard.
-static usb_dev_handle *FindKeyboard()
+static BOOL IsKeyboard(libusb_device *dev)
 {
-  struct usb_bus *bus;
-  struct usb_device *dev;
-  int i;
+  struct libusb_device_descriptor desc;
 
-  usb_find_busses();
-  usb_find_devices();
-
-  for (bus = usb_get_busses(); NULL != bus; bus = bus->next) {
-    for (dev = bus->devices; NULL != dev; dev = dev->next) {
-      if ((dev->descriptor.idVendor == VENDOR) &&
-          (dev->descriptor.idProduct == PRODUCT)) {
-        usb_dev_handle *devh = usb_open(dev);
-        if (NULL != devh) {
-          for (i = 0; i < 4; i++) {
-            if (usb_claim_interface(devh, 0) == 0)
-              break;
-            if (i > 3) {
-              usb_close(devh);
-              devh = NULL;
-              break;
-            }
-            // Attempt to force open by releasing kernel claimant.
-            usb_detach_kernel_driver_np(devh, 0);
-          }
-          if (NULL != devh) {
-            printf("Found LispM keyboard at %s/%s.\n", bus->dirname, dev->filename);
-            return devh;
-          }
-        }
-      }
+  return ((libusb_get_device_descriptor(dev, &desc) == 0) &&
+          (desc.idVendor == VENDOR) && (desc.idProduct == PRODUCT));
+}
+
+static void GetLocation(libusb_device *dev, lmkbd_Location *location)
+{
+  int nports;
+
+  memset(location, 0, sizeof(*location));
+  location->bus = libusb_get_bus_number(dev);
+  nports = libusb_get_port_numbers(dev, location->ports,
+                                   sizeof(location->ports));
+  location->nports = (nports < 0) ? 0 : nports;
+}
+
+static BOOL SameLocation(const lmkbd_Location *a, const lmkbd_Location *b)
+{
+  return ((a->bus == b->bus) && (a->nports == b->nports) &&
+          (memcmp(a->ports, b->ports, a->nports) == 0));
+}
+
+// As Linux names them: bus-port.port...
+static const char *FormatLocation(const lmkbd_Location *location,
+                                  char *buf, size_t size)
+{
+  int i, len;
+
+  len = snprintf(buf, size, "%d", location->bus);
+  for (i = 0; (i < location->nports) && (len < (int)size); i++)
+    len += snprintf(buf + len, size - len, "%c%d",
+                    (i == 0) ? '-' : '.', location->ports[i]);
+  return buf;
+}
+
+// Called with openLock held.
+static BOOL IsOpen(const lmkbd_Location *location)
+{
+  lmkbd_t *kbd;
+
+  for (kbd = openKeyboards; NULL != kbd; kbd = kbd->next) {
+    if (SameLocation(&kbd->location, location))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+// Called from libusb event handling, on any thread, as a keyboard comes
+// or goes.  Nothing synchronous can be done here, so one that comes back
+// is left for the reader of the handle it was opened under.
+static int LIBUSB_CALL Hotplug(libusb_context *ctx, libusb_device *dev,
+                               libusb_hotplug_event event, void *user_data)
+{
+  lmkbd_Location location;
+  lmkbd_t *kbd;
+
+  GetLocation(dev, &location);
+  pthread_mutex_lock(&openLock);
+  for (kbd = openKeyboards; NULL != kbd; kbd = kbd->next) {
+    if (!SameLocation(&kbd->location, &location))
+      continue;
+    pthread_mutex_lock(&kbd->reportLock);
+    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED) {
+      if (NULL != kbd->arrived)
+        libusb_unref_device(kbd->arrived);
+      kbd->arrived = libusb_ref_device(dev);
     }
+    else
+      kbd->transferError = LIBUSB_ERROR_NO_DEVICE;
+    kbd->reportsReady = 1;
+    pthread_mutex_unlock(&kbd->reportLock);
   }
-  return NULL;
+  pthread_mutex_unlock(&openLock);
+  return 0;
 }
 
-BOOL lmkbd_Open(lmkbd_EventMode eventMode)
+static void InitLibrary()
 {
-  if (!init) {
+  if (libusb_init(&context) != 0) {
+    context = NULL;
+    return;
+  }
 #if 0
-    usb_set_debug(255);
+  libusb_set_option(context, LIBUSB_OPTION_LOG_LEVEL, LIBUSB_LOG_LEVEL_DEBUG);
 #endif
-    usb_init();
-    init = TRUE;
+  if (libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG))
+    hotplug = (libusb_hotplug_register_callback(context,
+                                                LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED |
+                                                LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+                                                LIBUSB_HOTPLUG_NO_FLAGS,
+                                                VENDOR, PRODUCT,
+                                                LIBUSB_HOTPLUG_MATCH_ANY,
+                                                Hotplug, NULL,
+                                                &hotplugHandle) == 0);
+}
+
+int lmkbd_Enumerate(lmkbd_Location *locations, int max)
+{
+  libusb_device **devs;
+  ssize_t ndevs, i;
+  int n = 0;
+
+  pthread_once(&initOnce, InitLibrary);
+  if (NULL == context)
+    return -EIO;
+
+  ndevs = libusb_get_device_list(context, &devs);
+  if (ndevs < 0)
+    return -EIO;
+  for (i = 0; i < ndevs; i++) {
+    if (!IsKeyboard(devs[i]))
+      continue;
+    if (n < max)
+      GetLocation(devs[i], &locations[n]);
+    n++;
   }
+  libusb_free_device_list(devs, 1);
+  return n;
+}
 
-  lmkbd_Close();
+// Find and claim the LispM keyboard at location, or else the first one
+// not already open.  Called with openLock held.
+static libusb_device_handle *FindKeyboard(const lmkbd_Location *location,
+                                          lmkbd_Location *found)
+{
+  libusb_device **devs;
+  libusb_device_handle *devh = NULL;
+  ssize_t ndevs, i;
+  char name[32];
 
-  openHandle = FindKeyboard();
-  if (NULL == openHandle)
-    return FALSE;
+  ndevs = libusb_get_device_list(context, &devs);
+  if (ndevs < 0)
+    return NULL;
+
+  for (i = 0; i < ndevs; i++) {
+    if (!IsKeyboard(devs[i]))
+      continue;
+    GetLocation(devs[i], found);
+    if ((NULL != location) ? !SameLocation(location, found) : IsOpen(found))
+      continue;
+    if (libusb_open(devs[i], &devh) != 0) {
+      devh = NULL;
+      continue;
+    }
+    // Have any kernel claimant let go, and take it back on release.
+    libusb_set_auto_detach_kernel_driver(devh, 1);
+    if (libusb_claim_interface(devh, KBD_INTERFACE) == 0) {
+      printf("Found LispM keyboard at %s.\n",
+             FormatLocation(found, name, sizeof(name)));
+      break;
+    }
+    libusb_close(devh);
+    devh = NULL;
+  }
+  libusb_free_device_list(devs, 1);
+  return devh;
+}
+
+// Get or set a report on the keyboard interface.
+static int ControlReport(lmkbd_t *kbd, BOOL in, int type,
+                         unsigned char *data, int len)
+{
+  return libusb_control_transfer(kbd->devh,
+                                 (in ? LIBUSB_ENDPOINT_IN : LIBUSB_ENDPOINT_OUT) |
+                                 LIBUSB_REQUEST_TYPE_CLASS |
+                                 LIBUSB_RECIPIENT_INTERFACE,
+                                 in ? HID_REPORT_GET : HID_REPORT_SET,
+                                 (type << 8) | 0,
+                                 KBD_INTERFACE,
+                                 data, len,
+                                 USB_TIMEOUT);
+}
+
+static long long Microseconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
 
-  openMode = eventMode;
+// Called from libusb event handling, on any thread, as each interrupt
+// transfer is done.
+static void LIBUSB_CALL ReportDone(struct libusb_transfer *transfer)
+{
+  lmkbd_t *kbd = (lmkbd_t *)transfer->user_data;
+  BOOL resubmit = FALSE;
+
+  pthread_mutex_lock(&kbd->reportLock);
+  switch (transfer->status) {
+  case LIBUSB_TRANSFER_COMPLETED:
+    {
+      int next = (kbd->reportIn + 1) % N_REPORTS;
+      if (next == kbd->reportOut)
+        kbd->reportsLost++;     // Reader is far behind.
+      else {
+        Report *report = &kbd->reports[kbd->reportIn];
+        memcpy(report->data, transfer->buffer, transfer->actual_length);
+        report->len = transfer->actual_length;
+        report->received = Microseconds();
+        kbd->reportIn = next;
+      }
+    }
+    resubmit = !kbd->stopping;
+    break;
+  case LIBUSB_TRANSFER_CANCELLED:
+    break;
+  case LIBUSB_TRANSFER_NO_DEVICE:
+    kbd->transferError = LIBUSB_ERROR_NO_DEVICE;
+    break;
+  default:
+    kbd->transferError = LIBUSB_ERROR_IO;
+    break;
+  }
+  // Straight back to the host controller, behind the others.
+  if (resubmit && (libusb_submit_transfer(transfer) != 0)) {
+    kbd->transferError = LIBUSB_ERROR_IO;
+    resubmit = FALSE;
+  }
+  if (!resubmit)
+    kbd->transfersActive--;
+  kbd->reportsReady = 1;
+  pthread_mutex_unlock(&kbd->reportLock);
+}
+
+// Each transfer asks for one packet, so that it completes with exactly
+// one report, even when reports fill their packets.
+static BOOL StartTransfers(lmkbd_t *kbd)
+{
+  int i;
+
+  for (i = 0; i < N_TRANSFERS; i++) {
+    kbd->transfers[i] = libusb_alloc_transfer(0);
+    if (NULL == kbd->transfers[i])
+      return FALSE;
+    libusb_fill_interrupt_transfer(kbd->transfers[i], kbd->devh, KBD_ENDPOINT,
+                                   kbd->transferBuffers[i],
+                                   kbd->reportSize,
+                                   ReportDone, kbd, 0);
+    pthread_mutex_lock(&kbd->reportLock);
+    if (libusb_submit_transfer(kbd->transfers[i]) == 0)
+      kbd->transfersActive++;
+    else
+      kbd->transferError = LIBUSB_ERROR_IO;
+    pthread_mutex_unlock(&kbd->reportLock);
+    if (kbd->transferError != 0)
+      return FALSE;
+  }
+  return TRUE;
+}
 
+static void StopTransfers(lmkbd_t *kbd)
+{
+  int i, active;
+
+  pthread_mutex_lock(&kbd->reportLock);
+  kbd->stopping = TRUE;
+  pthread_mutex_unlock(&kbd->reportLock);
+  for (i = 0; i < N_TRANSFERS; i++) {
+    if (NULL != kbd->transfers[i])
+      libusb_cancel_transfer(kbd->transfers[i]);
+  }
+  while (1) {
+    pthread_mutex_lock(&kbd->reportLock);
+    active = kbd->transfersActive;
+    kbd->reportsReady = 0;
+    pthread_mutex_unlock(&kbd->reportLock);
+    if (active <= 0)
+      break;
+    struct timeval tv = { 0, 100000 };
+    if (libusb_handle_events_timeout_completed(context, &tv,
+                                               &kbd->reportsReady) < 0)
+      break;
+  }
+  for (i = 0; i < N_TRANSFERS; i++) {
+    libusb_free_transfer(kbd->transfers[i]);
+    kbd->transfers[i] = NULL;
+  }
+}
+
+// The most a report can be, as the endpoint's packet size.  Reading
+// any more lets a transfer take several full-sized reports together.
+static int ReportSize(lmkbd_t *kbd)
+{
+  int size = libusb_get_max_packet_size(libusb_get_device(kbd->devh),
+                                        KBD_ENDPOINT);
+  if ((size <= 0) || (size > NKRO_REPORT_SIZE + TIMESTAMP_SIZE))
+    size = NKRO_REPORT_SIZE + TIMESTAMP_SIZE;
+  return size;
+}
+
+// Put a keyboard just claimed into the state this library wants, and
+// start reading it.  oldMode gets the translation mode it was in.
+static BOOL SetUp(lmkbd_t *kbd, lmkbd_TranslationMode *oldMode)
+{
   int len;
 
+  kbd->reportSize = ReportSize(kbd);
+
   // Get features.
-  len = usb_control_msg(openHandle, 
-                        USB_ENDPOINT_IN + USB_TYPE_CLASS + USB_RECIP_INTERFACE,
-                        HID_REPORT_GET,
-                        (HID_RT_FEATURE << 8) | 0,
-                        0,
-                        features, sizeof(features),
-                        USB_TIMEOUT);
-  if (len < 0) {
-    lmkbd_Close();
+  len = ControlReport(kbd, TRUE, HID_RT_FEATURE,
+                      kbd->features, sizeof(kbd->features));
+  if (len < 0)
     return FALSE;
-  }
-  lmkbd_TranslationMode mode = (lmkbd_TranslationMode)features[1];
+  lmkbd_TranslationMode mode = (lmkbd_TranslationMode)kbd->features[1];
   if (mode != HUT1) {
-    features[1] = HUT1;         // Disable Emacs mode.
-    len = usb_control_msg(openHandle, 
-                          USB_ENDPOINT_OUT + USB_TYPE_CLASS + USB_RECIP_INTERFACE,
-                          HID_REPORT_SET,
-                          (HID_RT_FEATURE << 8) | 0,
-                          0,
-                          features, sizeof(features),
-                          USB_TIMEOUT);
-    if (len < 0) {
-      lmkbd_Close();
+    kbd->features[1] = HUT1;    // Disable Emacs mode.
+    len = ControlReport(kbd, FALSE, HID_RT_FEATURE,
+                        kbd->features, sizeof(kbd->features));
+    if (len < 0)
       return FALSE;
-    }
   }
-  oldMode = mode;
+  *oldMode = mode;
 
 #if 1
-  char leds[1] = { 0x0A };      // Show state for debugging.
-  len = usb_control_msg(openHandle, 
-                        USB_ENDPOINT_OUT + USB_TYPE_CLASS + USB_RECIP_INTERFACE,
-                        HID_REPORT_SET,
-                        (HID_RT_OUTPUT << 8) | 0,
-                        0,
-                        leds, sizeof(leds), 
-                        USB_TIMEOUT);
+  unsigned char leds[1] = { 0x0A }; // Show state for debugging.
+  len = ControlReport(kbd, FALSE, HID_RT_OUTPUT, leds, sizeof(leds));
 #endif
 
-  memset(&deviceUsages, 0, sizeof(deviceUsages));
-  memset(&clientUsages, 0, sizeof(clientUsages));
+  return StartTransfers(kbd);
+}
 
-  return TRUE;
+lmkbd_t *lmkbd_OpenAt(const lmkbd_Location *location,
+                      lmkbd_EventMode eventMode)
+{
+  lmkbd_t *kbd;
+
+  pthread_once(&initOnce, InitLibrary);
+  if (NULL == context)
+    return NULL;
+
+  kbd = (lmkbd_t *)calloc(1, sizeof(lmkbd_t));
+  if (NULL == kbd)
+    return NULL;
+  pthread_mutex_init(&kbd->readLock, NULL);
+  pthread_mutex_init(&kbd->reportLock, NULL);
+  kbd->mode = eventMode;
+  kbd->oldMode = HUT1;
+
+  // Claimed and listed together, so that two threads cannot both
+  // take the same one.
+  pthread_mutex_lock(&openLock);
+  kbd->devh = FindKeyboard(location, &kbd->location);
+  if (NULL != kbd->devh) {
+    kbd->next = openKeyboards;
+    openKeyboards = kbd;
+  }
+  pthread_mutex_unlock(&openLock);
+  if (NULL == kbd->devh) {
+    free(kbd);
+    return NULL;
+  }
+
+  if (!SetUp(kbd, &kbd->oldMode)) {
+    lmkbd_CloseHandle(kbd);
+    return NULL;
+  }
+
+  return kbd;
 }
 
-void lmkbd_Close()
+void lmkbd_CloseHandle(lmkbd_t *kbd)
 {
-  if (NULL == openHandle) return;
+  lmkbd_t **pkbd;
+
+  if (NULL == kbd) return;
 
   int len;
 
-  if (oldMode != HUT1) {
-    features[1] = oldMode;      // Restore Emacs mode.
-    len = usb_control_msg(openHandle, 
-                          USB_ENDPOINT_OUT + USB_TYPE_CLASS + USB_RECIP_INTERFACE,
-                          HID_REPORT_SET,
-                          (HID_RT_FEATURE << 8) | 0,
-                          0,
-                          features, sizeof(features),
-                          USB_TIMEOUT);
+  StopTransfers(kbd);
+
+  if ((NULL != kbd->devh) && (kbd->oldMode != HUT1)) {
+    kbd->features[1] = kbd->oldMode; // Restore Emacs mode.
+    len = ControlReport(kbd, FALSE, HID_RT_FEATURE,
+                        kbd->features, sizeof(kbd->features));
   }
 
+  if (kbd->reportsLost > 0)
+    printf("%lu reports lost.\n", kbd->reportsLost);
+
 #if 1
-  char leds[1] = { 0x00 };      // Clear state for debugging.
-  len = usb_control_msg(openHandle, 
-                        USB_ENDPOINT_OUT + USB_TYPE_CLASS + USB_RECIP_INTERFACE,
-                        HID_REPORT_SET,
-                        (HID_RT_OUTPUT << 8) | 0,
-                        0,
-                        leds, sizeof(leds), 
-                        USB_TIMEOUT);
+  unsigned char leds[1] = { 0x00 }; // Clear state for debugging.
+  if (NULL != kbd->devh)
+    len = ControlReport(kbd, FALSE, HID_RT_OUTPUT, leds, sizeof(leds));
 #endif
+  (void)len;
   
-  usb_release_interface(openHandle, 0);
-  usb_close(openHandle);
-  openHandle = NULL;
+  pthread_mutex_lock(&openLock);
+  for (pkbd = &openKeyboards; NULL != *pkbd; pkbd = &(*pkbd)->next) {
+    if (*pkbd == kbd) {
+      *pkbd = kbd->next;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&openLock);
+  if (NULL != kbd->devh) {
+    libusb_release_interface(kbd->devh, KBD_INTERFACE);
+    libusb_close(kbd->devh);
+  }
+  if (NULL != kbd->arrived)
+    libusb_unref_device(kbd->arrived);
+
+  pthread_mutex_destroy(&kbd->readLock);
+  pthread_mutex_destroy(&kbd->reportLock);
+  free(kbd);
 }
 
-lmkbd_Keyboard lmkbd_getKeyboard(void)
+lmkbd_Keyboard lmkbd_GetKeyboardOf(lmkbd_t *kbd)
 {
-  return (lmkbd_Keyboard)features[0];
+  return (lmkbd_Keyboard)kbd->features[0];
+}
+
+void lmkbd_GetLocation(lmkbd_t *kbd, lmkbd_Location *location)
+{
+  *location = kbd->location;
 }
 
 static inline BOOL IsShift(int usage)
@@ -436,28 +542,28 @@ static inline BOOL IsShift(int usage)
           ((usage >= 0x82) && (usage <= 0x84)));
 }
 
-static inline BOOL AnyNonShift()
+static inline BOOL AnyNonShift(const UsageSet *client)
 {
   int i;
   for (i = 0; i < 7; i++) {
     if (i == 4) {
       // 82-84 are also shifts.
-      if ((clientUsages.bits[i] & 0xFFFFFFE3) != 0)
+      if ((client->bits[i] & 0xFFFFFFE3) != 0)
         return TRUE;
     }
     else {
-      if (clientUsages.bits[i] != 0)
+      if (client->bits[i] != 0)
         return TRUE;
     }
   }
   return FALSE;
 }
 
-static inline unsigned long OldShifts()
+static inline unsigned long OldShifts(const UsageSet *client)
 {
   unsigned long result = 0;
 
-  unsigned long bits = clientUsages.bits[7];
+  unsigned long bits = client->bits[7];
   if (bits & (1 << 0x0)) {      // E0 left control
     result |= (1 << 4);
   }
@@ -483,7 +589,7 @@ static inline unsigned long OldShifts()
     result |= (1 << 3);
   }
 
-  bits = clientUsages.bits[4];
+  bits = client->bits[4];
   if (bits & (1 << 0x2)) {      // 82 locking caps lock
     result |= (1 << 8);
   }
@@ -491,11 +597,11 @@ static inline unsigned long OldShifts()
   return result;
 }
 
-static inline unsigned long NewShifts()
+static inline unsigned long NewShifts(const UsageSet *client)
 {
   unsigned long result = 0;
 
-  unsigned long bits = clientUsages.bits[7];
+  unsigned long bits = client->bits[7];
   if (bits & (1 << 0x0)) {      // E0 left control
     result |= (1 << 4);
   }
@@ -543,7 +649,7 @@ static inline unsigned long NewShifts()
   }
 
   
-  bits = clientUsages.bits[4];
+  bits = client->bits[4];
   if (bits & (1 << 0x2)) {      // 82 locking caps lock
     result |= (1 << 3);
   }
@@ -557,99 +663,491 @@ static inline unsigned long NewShifts()
   return result;
 }
 
-static inline void SetDeviceUsage(int usage)
+
+static inline void SetDeviceUsage(UsageSet *device, int usage)
 {
-  deviceUsages.bits[usage / 32] |= (1 << (usage % 32));
+  device->bits[usage / 32] |= (1UL << (usage % 32));
 }
 
-static inline void SetDeviceUsages(const unsigned char *pkt)
+static inline void SetDeviceUsages(UsageSet *device,
+                                   const unsigned char *pkt, int len)
 {
-  memset(&deviceUsages, 0, sizeof(deviceUsages));
+  memset(device, 0, sizeof(*device));
   int i;
+  if (len >= NKRO_REPORT_SIZE) {
+    for (i = 0; i < NKRO_REPORT_SIZE; i++) {
+      device->bits[i / 4] |= (unsigned long)pkt[i] << ((i % 4) * 8);
+    }
+    return;
+  }
   for (i = 0; i < 8; i++) {
     if (pkt[0] & (1 << i)) {
-      SetDeviceUsage(0xE0 + i);
+      SetDeviceUsage(device, 0xE0 + i);
     }
   }
-  for (i = 2; i < 8; i++) {
+  for (i = 2; i < BOOT_REPORT_SIZE; i++) {
     if (pkt[i] != 0) {
-      SetDeviceUsage(pkt[i]);
+      SetDeviceUsage(device, pkt[i]);
     }
   }
 }
 
-int lmkbd_Read(long timeout)
+static inline void CountLatency(unsigned long *histogram, long long us)
 {
-  unsigned char pkt[8];
-  while (1) {
-    // Look for difference in state and return it to client as event.
-    int i, j;
-    for (i = 0; i < 8; i++) {
-      unsigned long dbits = deviceUsages.bits[i];
-      unsigned long diffs = dbits ^ clientUsages.bits[i];
-      if (0 != diffs) {
-        for (j = 0; j < 32; j++) {
-          unsigned long mask = (1 << j);
-          if (diffs & mask) {
-            int usage = i * 32 + j;
-            switch (openMode) {
-            case CADR:
-              {
-                BOOL newFormat = (lmkbd_getKeyboard() != TK);
-                if (dbits & mask) {
-                  clientUsages.bits[i] |= mask;
-                  // Key down.
-                  if (newFormat) {
-                    return (0x00F90000 | KeyMappings[usage][SPACE_CADET]);
-                  }
-                  else if (!IsShift(usage)) { // No separate event for shift down.
-                    return (0x00FF0000 | OldShifts() | KeyMappings[usage][TK]);
-                  }
-                }
-                else {
-                  clientUsages.bits[i] &= ~mask;
-                  // Key up.
-                  if (newFormat) {
-                    if (IsShift(usage) || AnyNonShift()) {
-                      return (0x00F90000 | 0x0100 | KeyMappings[usage][SPACE_CADET]);
-                    }
-                    else {
-                      // All keys up for last non-shift.
-                      return (0x00F90000 | 0x8000 | NewShifts());
-                    }
-                  }
-                }
-              }
-              break;
-            case EXPLORER:
-              {
-                if (dbits & mask) {
-                  clientUsages.bits[i] |= mask;
-                  // Key down.
-                  return (0x80 | KeyMappings[usage][TI]);
-                }
-                else {
-                  clientUsages.bits[i] &= ~mask;
-                  // Key up.
-                  return KeyMappings[usage][TI];
-                }
-              }
-              break;
-            }
-          }
-        }
+  long bucket = us / 1000;
+  if (bucket < 0)
+    bucket = 0;
+  if (bucket >= N_LATENCY_BUCKETS)
+    bucket = N_LATENCY_BUCKETS - 1;
+  histogram[bucket]++;
+}
+
+// Note the timestamp from a report received at now.
+static void ReportTimestamp(lmkbd_t *kbd, const unsigned char *ts,
+                            long long now)
+{
+  unsigned short device = ts[0] | (ts[1] << 8);
+  unsigned short host = (unsigned short)(now * TIMESTAMP_HZ / 1000000);
+  unsigned short diff = host - device;
+  short least = 0;
+  int i;
+
+  kbd->offsetSamples[kbd->offsetSampleIndex] = diff;
+  kbd->offsetSampleIndex = (kbd->offsetSampleIndex + 1) % N_OFFSET_SAMPLES;
+  if (kbd->nOffsetSamples < N_OFFSET_SAMPLES)
+    kbd->nOffsetSamples++;
+  // Differences are compared signed, so the wrap every 350 ms of the
+  // 16-bit counts does not matter.
+  for (i = 0; i < kbd->nOffsetSamples; i++) {
+    short delta = (short)(kbd->offsetSamples[i] - diff);
+    if (delta < least)
+      least = delta;
+  }
+  CountLatency(kbd->deviceLatency, -least * 1000000LL / TIMESTAMP_HZ);
+}
+
+static void PrintHistogram(const char *title, const unsigned long *histogram)
+{
+  unsigned long total = 0;
+  int i, last = -1;
+
+  for (i = 0; i < N_LATENCY_BUCKETS; i++) {
+    if (histogram[i] != 0) {
+      total += histogram[i];
+      last = i;
+    }
+  }
+  if (total == 0)
+    return;
+  printf("%s (%lu events):\n", title, total);
+  for (i = 0; i <= last; i++) {
+    printf(" %s%2d ms %8lu %5.1f%%\n", 
+           (i == N_LATENCY_BUCKETS - 1) ? ">=" : "  ", i,
+           histogram[i], histogram[i] * 100.0 / total);
+  }
+}
+
+void lmkbd_PrintLatencyOf(lmkbd_t *kbd)
+{
+  pthread_mutex_lock(&kbd->readLock);
+  PrintHistogram("Key detected to report received, beyond the least seen",
+                 kbd->deviceLatency);
+  PrintHistogram("Report received to event returned", kbd->hostLatency);
+  pthread_mutex_unlock(&kbd->readLock);
+}
+
+// The event for a change in one usage, noting it as told to the
+// client, or -1 if the change has none.
+static int UsageEvent(lmkbd_t *kbd, int usage, BOOL down)
+{
+  UsageSet *client = &kbd->clientUsages;
+  int i = usage / 32;
+  unsigned long mask = 1UL << (usage % 32);
+
+  if (down)
+    client->bits[i] |= mask;
+  else
+    client->bits[i] &= ~mask;
+
+  switch (kbd->mode) {
+  case CADR:
+    if (lmkbd_GetKeyboardOf(kbd) != TK) {
+      if (down)
+        return (0x00F90000 | KeyMappings[usage][SPACE_CADET]);
+      else if (IsShift(usage) || AnyNonShift(client))
+        return (0x00F90000 | 0x0100 | KeyMappings[usage][SPACE_CADET]);
+      else
+        // All keys up for last non-shift.
+        return (0x00F90000 | 0x8000 | NewShifts(client));
+    }
+    else if (down && !IsShift(usage)) // No separate event for shift down.
+      return (0x00FF0000 | OldShifts(client) | KeyMappings[usage][TK]);
+    break;
+  case EXPLORER:
+    if (down)
+      return (0x80 | KeyMappings[usage][TI]);
+    else
+      return KeyMappings[usage][TI];
+  }
+  return -1;
+}
+
+// Turn differences between the device's state and what the client has
+// been told into as many as max events, in usage order.  Each word is
+// compared once, and its changed bits taken lowest first.
+static int DiffEvents(lmkbd_t *kbd, int *events, int max)
+{
+  int i, n = 0;
+  long long now = Microseconds();
+
+  for (i = 0; (i < 8) && (n < max); i++) {
+    unsigned long dbits = kbd->deviceUsages.bits[i];
+    unsigned long diffs = dbits ^ kbd->clientUsages.bits[i];
+    while ((0 != diffs) && (n < max)) {
+      int j = __builtin_ctzl(diffs);
+      diffs &= diffs - 1;
+      int event = UsageEvent(kbd, i * 32 + j, (dbits >> j) & 1);
+      if (event >= 0) {
+        events[n++] = event;
+        if (kbd->nOffsetSamples > 0) // Only with timestamps.
+          CountLatency(kbd->hostLatency, now - kbd->reportReceived);
       }
     }
-    // Get usage report and update device state from it.
-    int len = usb_interrupt_read(openHandle, 1, (char *)pkt, sizeof(pkt), timeout);
-    if (len < 0) 
-      return len;
+  }
+  return n;
+}
+
+// Take the next report received, if there is one, and otherwise note
+// that the reader is about to wait.  Returns any error that stopped
+// the transfers, if there is no report.
+static int TakeReport(lmkbd_t *kbd, Report *report, BOOL *taken)
+{
+  int error = 0;
+
+  pthread_mutex_lock(&kbd->reportLock);
+  *taken = (kbd->reportOut != kbd->reportIn);
+  if (*taken) {
+    *report = kbd->reports[kbd->reportOut];
+    kbd->reportOut = (kbd->reportOut + 1) % N_REPORTS;
+  }
+  else {
+    kbd->reportsReady = 0;
+    error = kbd->transferError;
+  }
+  pthread_mutex_unlock(&kbd->reportLock);
+  return error;
+}
+
+// Update device state from a report received.
+static void ApplyReport(lmkbd_t *kbd, const Report *report)
+{
+  kbd->reportReceived = report->received;
+  if ((report->len == BOOT_REPORT_SIZE + TIMESTAMP_SIZE) ||
+      (report->len == NKRO_REPORT_SIZE + TIMESTAMP_SIZE))
+    ReportTimestamp(kbd, report->data + report->len - TIMESTAMP_SIZE,
+                    kbd->reportReceived);
 #if 0
-    for (i = 0; i < 8; i++) {
-      printf("%02X ", pkt[i]);
-    }
-    printf("\n");
+  int i;
+  for (i = 0; i < report->len; i++) {
+    printf("%02X ", report->data[i]);
+  }
+  printf("\n");
 #endif
-    SetDeviceUsages(pkt);
+  SetDeviceUsages(&kbd->deviceUsages, report->data, report->len);
+}
+
+// As the old libusb returned them: negative errno.
+static int ErrorResult(int error)
+{
+  switch (error) {
+  case LIBUSB_ERROR_TIMEOUT:
+    return -ETIMEDOUT;
+  case LIBUSB_ERROR_NO_DEVICE:
+    return -ENODEV;
+  case LIBUSB_ERROR_INTERRUPTED:
+    return -EINTR;
+  case LIBUSB_ERROR_NO_MEM:
+    return -ENOMEM;
+  default:
+    return -EIO;
+  }
+}
+
+// The keyboard was unplugged: stop reading it and have the client
+// told that any keys it held are up.
+static void Disconnect(lmkbd_t *kbd)
+{
+  char name[32];
+
+  printf("LispM keyboard at %s unplugged.\n",
+         FormatLocation(&kbd->location, name, sizeof(name)));
+  StopTransfers(kbd);
+  libusb_close(kbd->devh);
+  kbd->devh = NULL;
+  memset(&kbd->deviceUsages, 0, sizeof(kbd->deviceUsages));
+  kbd->disconnected = TRUE;
+}
+
+// Take up again a keyboard plugged back in where it was, in the same
+// state as when first opened, and with the keys held now.  Returns
+// FALSE while there is none.
+static BOOL Reconnect(lmkbd_t *kbd)
+{
+  libusb_device *dev;
+  lmkbd_TranslationMode mode;
+  unsigned char pkt[NKRO_REPORT_SIZE + TIMESTAMP_SIZE];
+  char name[32];
+  int len;
+
+  pthread_mutex_lock(&kbd->reportLock);
+  dev = kbd->arrived;
+  kbd->arrived = NULL;
+  pthread_mutex_unlock(&kbd->reportLock);
+  if (NULL == dev)
+    return FALSE;
+
+  if (libusb_open(dev, &kbd->devh) != 0)
+    kbd->devh = NULL;
+  libusb_unref_device(dev);
+  if (NULL == kbd->devh)
+    return FALSE;
+  libusb_set_auto_detach_kernel_driver(kbd->devh, 1);
+
+  pthread_mutex_lock(&kbd->reportLock);
+  kbd->transferError = 0;
+  kbd->stopping = FALSE;
+  kbd->reportIn = kbd->reportOut = 0;
+  pthread_mutex_unlock(&kbd->reportLock);
+
+  if ((libusb_claim_interface(kbd->devh, KBD_INTERFACE) != 0) ||
+      !SetUp(kbd, &mode)) {
+    StopTransfers(kbd);
+    libusb_close(kbd->devh);
+    kbd->devh = NULL;
+    pthread_mutex_lock(&kbd->reportLock);
+    kbd->transferError = LIBUSB_ERROR_NO_DEVICE;
+    pthread_mutex_unlock(&kbd->reportLock);
+    return FALSE;
+  }
+
+  // Whatever is held already will not be reported until it changes.
+  len = ControlReport(kbd, TRUE, HID_RT_INPUT, pkt, kbd->reportSize);
+  if (len > 0)
+    SetDeviceUsages(&kbd->deviceUsages, pkt, len);
+  kbd->disconnected = FALSE;
+  kbd->errorReported = FALSE;
+  printf("LispM keyboard at %s plugged back in.\n",
+         FormatLocation(&kbd->location, name, sizeof(name)));
+  return TRUE;
+}
+
+static int ReadEvents(lmkbd_t *kbd, int *events, int max, long timeout)
+{
+  long long deadline = Microseconds() + timeout * 1000LL;
+  BOOL polled = FALSE, taken;
+  Report report;
+  int n = 0, error;
+
+  while (n < max) {
+    // Events from the state so far come before any later report's.
+    n += DiffEvents(kbd, events + n, max - n);
+    if (n >= max)
+      break;
+    error = TakeReport(kbd, &report, &taken);
+    if (taken) {
+      ApplyReport(kbd, &report);
+      continue;
+    }
+    if (n > 0) {
+      // Take any transfers done meanwhile too, but do not wait.
+      if (polled)
+        break;
+      polled = TRUE;
+      struct timeval zero = { 0, 0 };
+      libusb_handle_events_timeout_completed(context, &zero, NULL);
+      continue;
+    }
+    if ((error == LIBUSB_ERROR_NO_DEVICE) && hotplug) {
+      // Wait as long as it takes for it to come back.
+      if (!kbd->disconnected) {
+        Disconnect(kbd);
+        continue;
+      }
+      if (Reconnect(kbd))
+        continue;
+    }
+    else if (error != 0)
+      return ErrorResult(error);
+    if (timeout == NO_WAIT)
+      break;
+    // Wait for more.  The transfers stay submitted meanwhile, so none
+    // is missed whenever the client calls.  Whichever thread handles
+    // events completes all keyboards' transfers; this one stops
+    // waiting once any of its own are done.
+    int rc;
+    struct timeval tv;
+    if (timeout > 0) {
+      long long remaining = deadline - Microseconds();
+      if (remaining <= 0)
+        return -ETIMEDOUT;
+      tv.tv_sec = remaining / 1000000;
+      tv.tv_usec = remaining % 1000000;
+    }
+    else {
+      tv.tv_sec = 60;
+      tv.tv_usec = 0;
+    }
+    rc = libusb_handle_events_timeout_completed(context, &tv,
+                                                &kbd->reportsReady);
+    if ((rc < 0) && (rc != LIBUSB_ERROR_INTERRUPTED))
+      return ErrorResult(rc);
   }
+  return n;
+}
+
+int lmkbd_ReadManyFrom(lmkbd_t *kbd, int *events, int max, long timeout)
+{
+  int n;
+
+  pthread_mutex_lock(&kbd->readLock);
+  n = ReadEvents(kbd, events, max, timeout);
+  pthread_mutex_unlock(&kbd->readLock);
+  return n;
+}
+
+int lmkbd_ReadFrom(lmkbd_t *kbd, long timeout)
+{
+  int event;
+  int n = lmkbd_ReadManyFrom(kbd, &event, 1, timeout);
+  return (n > 0) ? event : n;
+}
+
+/**** Reading from the client's own event loop ****/
+
+int lmkbd_GetPollFds(lmkbd_PollFd *fds, int max)
+{
+  const struct libusb_pollfd **pollfds;
+  int n;
+
+  pthread_once(&initOnce, InitLibrary);
+  if (NULL == context)
+    return -EIO;
+
+  pollfds = libusb_get_pollfds(context);
+  if (NULL == pollfds)
+    return -ENOSYS;
+  for (n = 0; NULL != pollfds[n]; n++) {
+    if (n < max) {
+      fds[n].fd = pollfds[n]->fd;
+      fds[n].events = pollfds[n]->events;
+    }
+  }
+  libusb_free_pollfds(pollfds);
+  return n;
+}
+
+void lmkbd_SetPollFdNotifiers(lmkbd_PollFdAdded added,
+                              lmkbd_PollFdRemoved removed, void *data)
+{
+  pthread_once(&initOnce, InitLibrary);
+  if (NULL == context)
+    return;
+  libusb_set_pollfd_notifiers(context, added, removed, data);
+}
+
+long lmkbd_GetTimeout(void)
+{
+  struct timeval tv;
+
+  pthread_once(&initOnce, InitLibrary);
+  if ((NULL == context) || libusb_pollfds_handle_timeouts(context) ||
+      (libusb_get_next_timeout(context, &tv) != 1))
+    return -1;
+  return tv.tv_sec * 1000 + (tv.tv_usec + 999) / 1000;
+}
+
+int lmkbd_Dispatch(lmkbd_EventHandler handler, void *data)
+{
+  struct timeval zero = { 0, 0 };
+  int events[N_DISPATCH_EVENTS];
+  lmkbd_t *kbd, *next;
+  int rc, n, total = 0;
+
+  pthread_once(&initOnce, InitLibrary);
+  if (NULL == context)
+    return -EIO;
+
+  // Complete whatever transfers are done, for every keyboard.
+  rc = libusb_handle_events_timeout_completed(context, &zero, NULL);
+  if ((rc < 0) && (rc != LIBUSB_ERROR_INTERRUPTED))
+    return ErrorResult(rc);
+
+  // Not holding openLock while reading, which can take hotplug
+  // callbacks; the keyboards are this thread's to close.
+  pthread_mutex_lock(&openLock);
+  kbd = openKeyboards;
+  pthread_mutex_unlock(&openLock);
+  while (NULL != kbd) {
+    // Found first, since the handler may close this one.
+    pthread_mutex_lock(&openLock);
+    next = kbd->next;
+    pthread_mutex_unlock(&openLock);
+    do {
+      pthread_mutex_lock(&kbd->readLock);
+      n = ReadEvents(kbd, events, N_DISPATCH_EVENTS, NO_WAIT);
+      if (n < 0) {
+        // Only once, not again on every call until it is closed.
+        if (kbd->errorReported)
+          n = 0;
+        kbd->errorReported = TRUE;
+      }
+      pthread_mutex_unlock(&kbd->readLock);
+      if (n != 0)
+        handler(kbd, events, n, data);
+      if (n > 0)
+        total += n;
+    } while (n == N_DISPATCH_EVENTS);
+    kbd = next;
+  }
+  return total;
+}
+
+/**** The first keyboard, without a handle ****/
+
+BOOL lmkbd_Open(lmkbd_EventMode eventMode)
+{
+  if (NULL == defaultKeyboard)
+    defaultKeyboard = lmkbd_OpenAt(NULL, eventMode);
+  return (NULL != defaultKeyboard);
+}
+
+void lmkbd_Close()
+{
+  lmkbd_CloseHandle(defaultKeyboard);
+  defaultKeyboard = NULL;
+}
+
+lmkbd_Keyboard lmkbd_GetKeyboard(void)
+{
+  return lmkbd_GetKeyboardOf(defaultKeyboard);
+}
+
+int lmkbd_ReadMany(int *events, int max, long timeout)
+{
+  if (NULL == defaultKeyboard)
+    return -ENODEV;
+  return lmkbd_ReadManyFrom(defaultKeyboard, events, max, timeout);
+}
+
+int lmkbd_Read(long timeout)
+{
+  if (NULL == defaultKeyboard)
+    return -ENODEV;
+  return lmkbd_ReadFrom(defaultKeyboard, timeout);
+}
+
+void lmkbd_PrintLatency()
+{
+  if (NULL != defaultKeyboard)
+    lmkbd_PrintLatencyOf(defaultKeyboard);
 }
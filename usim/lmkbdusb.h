@@ -8,13 +8,86 @@ typedef enum {
 } lmkbd_EventMode;
 
 typedef enum {
-  HUT1 = 1, EMACS
+  HUT1 = 1, EMACS, KEYSYM
 } lmkbd_TranslationMode;
 
 typedef int BOOL;
 #define FALSE 0
 #define TRUE 1
 
+/** An open keyboard.  Each can be read on its own thread, or several
+ * in turn from one; one thread at a time reads any one keyboard. */
+typedef struct lmkbd lmkbd_t;
+
+/** Where a keyboard is plugged in: bus and the hub ports to it. */
+typedef struct {
+  int bus;
+  int nports;
+  unsigned char ports[7];
+} lmkbd_Location;
+
+/** Find the LispM keyboards attached, storing up to max locations.
+ * Returns how many there are, or negative errno. */
+int lmkbd_Enumerate(lmkbd_Location *locations, int max);
+
+/** Open the keyboard at location, or the first one not already open
+ * if NULL.  Returns NULL if there is none that can be claimed. */
+lmkbd_t *lmkbd_OpenAt(const lmkbd_Location *location,
+                      lmkbd_EventMode eventMode);
+
+/** Close a keyboard, which no other thread may be reading. */
+void lmkbd_CloseHandle(lmkbd_t *kbd);
+
+/** Get the type of a keyboard. */
+lmkbd_Keyboard lmkbd_GetKeyboardOf(lmkbd_t *kbd);
+
+/** Get where a keyboard is plugged in. */
+void lmkbd_GetLocation(lmkbd_t *kbd, lmkbd_Location *location);
+
+/** As lmkbd_Read and lmkbd_ReadMany, from a keyboard. */
+int lmkbd_ReadFrom(lmkbd_t *kbd, long timeout);
+int lmkbd_ReadManyFrom(lmkbd_t *kbd, int *events, int max, long timeout);
+
+/** As lmkbd_PrintLatency, for a keyboard. */
+void lmkbd_PrintLatencyOf(lmkbd_t *kbd);
+
+/** A file descriptor for the client's own poll loop to watch. */
+typedef struct {
+  int fd;
+  short events;                 /* As for poll(2). */
+} lmkbd_PollFd;
+
+/** Store up to max descriptors that become ready when there may be
+ * keyboard input.  Returns how many there are, or negative errno
+ * (-ENOSYS where libusb cannot give them). */
+int lmkbd_GetPollFds(lmkbd_PollFd *fds, int max);
+
+/** Be told as descriptors are added and removed, which can happen as
+ * keyboards are opened and closed. */
+typedef void (*lmkbd_PollFdAdded)(int fd, short events, void *data);
+typedef void (*lmkbd_PollFdRemoved)(int fd, void *data);
+void lmkbd_SetPollFdNotifiers(lmkbd_PollFdAdded added,
+                              lmkbd_PollFdRemoved removed, void *data);
+
+/** How many ms until lmkbd_Dispatch must be called even with no
+ * descriptor ready, or -1 if never (as on Linux). */
+long lmkbd_GetTimeout(void);
+
+/** Called by lmkbd_Dispatch with n events from a keyboard, or with n
+ * negative errno, as lmkbd_ReadFrom returns, if it can no longer be
+ * read.  An error is passed only once, and the handler may then close
+ * that keyboard. */
+typedef void (*lmkbd_EventHandler)(lmkbd_t *kbd, const int *events, int n,
+                                   void *data);
+
+/** Without waiting, take whatever input there is for every open
+ * keyboard and hand it to handler.  Returns how many events there were,
+ * or negative errno.  For a thread that reads all the keyboards; the
+ * handler must not close any but one whose error it is given. */
+int lmkbd_Dispatch(lmkbd_EventHandler handler, void *data);
+
+/* The rest work on one keyboard, as lmkbd_OpenAt(NULL, ...) finds. */
+
 /** Open a LispM keyboard via USB. */
 BOOL lmkbd_Open(lmkbd_EventMode eventMode);
 
@@ -24,5 +97,16 @@ void lmkbd_Close();
 /** Get the type of keyboard opened. */
 lmkbd_Keyboard lmkbd_GetKeyboard(void);
 
-/** Get the next event in CADR format (24-bit integer). */
+/** Get the next event in CADR format (24-bit integer).
+ * Waits up to timeout ms, or for ever if 0.  Negative errno on error:
+ * -ETIMEDOUT if nothing came, -ENODEV if the keyboard went away. */
 int lmkbd_Read(long timeout);
+
+/** Get all the events there are, up to max, in order, waiting as
+ * lmkbd_Read does only for the first.  Returns how many, or negative
+ * errno as lmkbd_Read does. */
+int lmkbd_ReadMany(int *events, int max, long timeout);
+
+/** Print latency histograms, if the keyboard sends timestamps.
+ * Nothing is printed otherwise, nor by closing. */
+void lmkbd_PrintLatency(void);
@@ -0,0 +1,121 @@
+;;; -*- Mode: Emacs-Lisp; coding: utf-8 -*-
+;;; Generated by keymap/genkeys.py from keymap/lmkbd.keys.  Do not edit.
+
+(defconst lmkbd-unicode-keysyms
+  '((alpha . #x03B1)        ;α
+    (approximate . #x2248)  ;≈
+    (atsign . #x0040)       ;@
+    (beta . #x03B2)         ;β
+    (braceleft . #x007B)    ;{
+    (braceright . #x007D)   ;}
+    (bracketleft . #x005B)  ;[
+    (bracketright . #x005D) ;]
+    (broketleft . #x231C)   ;⌜
+    (broketright . #x231E)  ;⌞
+    (caret . #x005E)        ;^
+    (ceiling . #x2308)      ;⌈
+    (cent . #x00A2)         ;¢
+    (chi . #x03C7)          ;χ
+    (circle . #x25CB)       ;○
+    (circleminus . #x2296)  ;⊖
+    (circleplus . #x2295)   ;⊕
+    (circleslash . #x2298)  ;⊘
+    (circletimes . #x2297)  ;⊗
+    (colon . #x003A)        ;:
+    (contained . #x2283)    ;⊃
+    (dagger . #x2020)       ;†
+    (degree . #x00B0)       ;°
+    (del . #x2207)          ;∇
+    (delta . #x2206)        ;∆
+    (division . #x00F7)     ;÷
+    (doubbaselinedot . #x00A8);¨
+    (doublearrow . #x2194)  ;↔
+    (doublebracketleft . #x27E6);⟦
+    (doublebracketright . #x27E7);⟧
+    (doubledagger . #x2021) ;‡
+    (doublevertbar . #x2016);‖
+    (downarrow . #x2193)    ;↓
+    (downtack . #x22A4)     ;⊤
+    (epsilon . #x03B5)      ;ε
+    (eta . #x03B7)          ;η
+    (exists . #x2203)       ;∃
+    (floor . #x230A)        ;⌊
+    (forall . #x2200)       ;∀
+    (gamma . #x03B3)        ;γ
+    (greaterthanequal . #x2265);≥
+    (guillemotleft . #x00AB);«
+    (guillemotright . #x00BB);»
+    (horizbar . #x2015)     ;―
+    (identical . #x2261)    ;≡
+    (includes . #x2282)     ;⊂
+    (infinity . #x221E)     ;∞
+    (integral . #x222B)     ;∫
+    (intersection . #x2229) ;∩
+    (iota . #x03B9)         ;ι
+    (kappa . #x03BA)        ;κ
+    (lambda . #x03BB)       ;λ
+    (leftanglebracket . #x2039);‹
+    (leftarrow . #x2190)    ;←
+    (lefttack . #x22A3)     ;⊣
+    (lessthanequal . #x2264);≤
+    (logicaland . #x2227)   ;∧
+    (logicalor . #x2228)    ;∨
+    (mu . #x03BC)           ;μ
+    (notequal . #x2260)     ;≠
+    (notsign . #x2310)      ;⌐
+    (nu . #x03BD)           ;ν
+    (omega . #x03C9)        ;ω
+    (omicron . #x03BF)      ;ο
+    (paragraph . #x00B6)    ;¶
+    (parenleft . #x0028)    ;(
+    (parenright . #x0029)   ;)
+    (partialderivative . #x2202);∂
+    (periodcentered . #x00B7);·
+    (phi . #x03C6)          ;φ
+    (pi . #x03C0)           ;π
+    (plusminus . #x00B1)    ;±
+    (psi . #x03C8)          ;ψ
+    (quad . #x2395)         ;⎕
+    (rho . #x03C1)          ;ρ
+    (rightanglebracket . #x203A);›
+    (rightarrow . #x2192)   ;→
+    (righttack . #x22A2)    ;⊢
+    (section . #x00A7)      ;§
+    (sigma . #x03C3)        ;σ
+    (similarequal . #x2243) ;≃
+    (tau . #x03C4)          ;τ
+    (theta . #x03B8)        ;θ
+    (times . #x00D7)        ;×
+    (union . #x222A)        ;∪
+    (uparrow . #x2191)      ;↑
+    (upsilon . #x03C5)      ;υ
+    (uptack . #x22A5)       ;⊥
+    (varsigma . #x03C2)     ;ς
+    (vartheta . #x03D1)     ;ϑ
+    (xi . #x03BE)           ;ξ
+    (zeta . #x03B6)         ;ζ)
+  "Keysyms that are graphic characters, with their Unicode.")
+
+(defconst lmkbd-keysyms
+  [nil abort alpha altmode approximate atsign backnext beta boldlock
+   braceleft braceright bracketleft bracketright break broketleft
+   broketright call caret ceiling cent chi circle circleminus
+   circleplus circleslash circletimes clear clearinput clearscreen
+   colon complete contained dagger degree del delta division
+   doubbaselinedot doublearrow doublebracketleft doublebracketright
+   doubledagger doublevertbar downarrow downtack epsilon escape eta
+   exists floor forall form function gamma greaterthanequal
+   guillemotleft guillemotright handleft handright help holdoutput
+   horizbar i identical ii iii includes infinity integral intersection
+   iota itallock iv kappa lambda left leftanglebracket leftarrow
+   lefttack lessthanequal line local logicaland logicalor macro middle
+   mu network notequal notsign nu omega omicron page paragraph
+   parenleft parenright partialderivative periodcentered phi pi
+   plusminus psi quad quote refresh resume rho right rightanglebracket
+   rightarrow righttack scroll section select sigma similarequal
+   square status stopoutput suspend system tau terminal theta
+   thumbdown thumbup times triangle undo union uparrow upsilon uptack
+   varsigma vartheta vertbar vt xi zeta]
+  "Keysyms in the order the keyboard numbers them.")
+
+(provide 'lmkbd-keys)
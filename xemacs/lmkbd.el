@@ -1,104 +1,12 @@
 ;;; -*- Mode: Emacs-Lisp; coding: utf-8 -*-
 
+;; The keysym lists are generated from keymap/lmkbd.keys.
+(require 'lmkbd-keys)
+
 ;; Some of these Unicode characters do not correspond to anything in a
 ;; character set that un-define knows about.  They get lost when this
 ;; file is loaded.
-(dolist (key '((alpha . #x03B1)         ;α
-               (approximate . #x2248)   ;≈
-               (atsign . #x0040)        ;@
-               (beta . #x03B2)          ;β
-               (braceleft . #x007B)     ;{
-               (braceright . #x007D)    ;}
-               (bracketleft . #x005B)   ;[
-               (bracketright . #x005D)  ;]
-               ;; These are only half of the legend.  Is there really
-               ;; a graphic char on this keyboard with no
-               ;; corresponding Unicode glyph?
-               (broketleft . #x231C)    ;⌜
-               (broketright . #x231E)   ;⌞
-               (caret . #x005E)         ;^
-               (ceiling . #x2308)       ;⌈
-               (cent . #x00A2)          ;¢
-               (chi . #x03C7)           ;χ
-               (circle . #x25CB)        ;○
-               (circleminus . #x2296)   ;⊖
-               (circleplus . #x2295)    ;⊕
-               (circleslash . #x2298)   ;⊘
-               (circletimes . #x2297)   ;⊗
-               (colon . #x003A)         ;:
-               (contained . #x2283)     ;⊃
-               (dagger . #x2020)        ;†
-               (degree . #x00B0)        ;°
-               (del . #x2207)           ;∇
-               (delta . #x2206)         ;∆
-               (division . #x00F7)      ;÷
-               (doubbaselinedot . #x00A8) ;¨
-               (doublearrow . #x2194)   ;↔
-               (doublebracketleft . #x27E6) ;⟦
-               (doublebracketright . #x27E7) ;⟧
-               (doubledagger . #x2021)  ;‡
-               (doublevertbar . #x2016) ;‖
-               (downarrow . #x2193)     ;↓
-               (downtack . #x22A4)      ;⊤
-               (epsilon . #x03B5)       ;ε
-               (eta . #x03B7)           ;η
-               (exists . #x2203)        ;∃
-               (floor . #x230A)         ;⌊
-               (forall . #x2200)        ;∀
-               (gamma . #x03B3)         ;γ
-               (greaterthanequal . #x2265) ;≥
-               (guillemotleft . #x00AB) ;«
-               (guillemotright . #x00BB) ;»
-               (horizbar . #x2015)      ;―
-               (identical . #x2261)     ;≡
-               (includes . #x2282)      ;⊂
-               (infinity . #x221E)      ;∞
-               (integral . #x222B)      ;∫
-               (intersection . #x2229)  ;∩
-               (iota . #x03B9)          ;ι
-               (kappa . #x03BA)         ;κ
-               (lambda . #x03BB)        ;λ
-               (leftanglebracket . #x2039) ;‹
-               (leftarrow . #x2190)     ;←
-               (lefttack . #x22A3)      ;⊣
-               (lessthanequal . #x2264) ;≤
-               (logicaland . #x2227)    ;∧
-               (logicalor . #x2228)     ;∨
-               (mu . #x03BC)            ;μ
-               (notequal . #x2260)      ;≠
-               (notsign . #x2310)       ;⌐
-               (nu . #x03BD)            ;ν
-               (omega . #x03C9)         ;ω
-               (omicron . #x03BF)       ;ο
-               (paragraph . #x00B6)     ;¶
-               (parenleft . #x0028)     ;(
-               (parenright . #x0029)    ;)
-               (partialderivative . #x2202) ;∂
-               (periodcentered . #x00B7) ;·
-               (phi . #x03C6)           ;φ
-               (pi . #x03C0)            ;π
-               (plusminus . #x00B1)     ;±
-               (psi . #x03C8)           ;ψ
-               (quad . #x2395)          ;⎕
-               (rho . #x03C1)           ;ρ
-               (rightanglebracket . #x203A) ;›
-               (rightarrow . #x2192)    ;→
-               (righttack . #x22A2)     ;⊢
-               (section . #x00A7)       ;§
-               (sigma . #x03C3)         ;σ
-               (similarequal . #x2243)  ;≃
-               (tau . #x03C4)           ;τ
-               (theta . #x03B8)         ;θ
-               (times . #x00D7)         ;×
-               (union . #x222A)         ;∪
-               (uparrow . #x2191)       ;↑
-               (upsilon . #x03C5)       ;υ
-               (uptack . #x22A5)        ;⊥
-               (varsigma . #x03C2)      ;ς
-               (vartheta . #x03D1)      ;ϑ
-               (xi . #x03BE)            ;ξ
-               (zeta . #x03B6)          ;ζ
-               ))
+(dolist (key lmkbd-unicode-keysyms)
   (if (null (get (car key) character-set-property))
       (let ((char (ucs-to-char (cdr key))))
         (if (null char)
@@ -113,3 +21,68 @@
                (scroll . [(control v)])
                ))
   (define-key global-map (car key) (cdr key)))
+
+;; Keysym events from the keyboard's vendor interface, when it is in
+;; KEYSYM translation mode.  Each event is one four byte report: ID,
+;; modifiers, keysym index and the key's HID usage.
+(defvar lmkbd-hidraw-device "/dev/hidraw1"
+  "The hidraw device for the LispM keyboard's vendor interface.")
+
+(defconst lmkbd-usage-keys
+  [?a ?b ?c ?d ?e ?f ?g ?h ?i ?j ?k ?l ?m ?n ?o ?p ?q ?r ?s ?t ?u ?v ?w
+   ?x ?y ?z ?1 ?2 ?3 ?4 ?5 ?6 ?7 ?8 ?9 ?0
+   return escape backspace tab space ?- ?= ?\[ ?\] ?\\ ?# ?\; ?' ?` ?, ?. ?/]
+  "Keys for HID usages #x04 - #x38, for events with no keysym.")
+
+(defvar lmkbd-keysym-process nil)
+(defvar lmkbd-keysym-pending "")
+
+(defun lmkbd-start-keysym-events ()
+  "Read keysym events from `lmkbd-hidraw-device' as command input."
+  (interactive)
+  (lmkbd-stop-keysym-events)
+  (let ((process-connection-type nil))
+    (setq lmkbd-keysym-process
+          (start-process "lmkbd" nil "cat" lmkbd-hidraw-device)))
+  (set-process-coding-system lmkbd-keysym-process 'binary 'binary)
+  (set-process-filter lmkbd-keysym-process 'lmkbd-keysym-filter)
+  (process-kill-without-query lmkbd-keysym-process))
+
+(defun lmkbd-stop-keysym-events ()
+  "Stop reading keysym events."
+  (interactive)
+  (when lmkbd-keysym-process
+    (delete-process lmkbd-keysym-process)
+    (setq lmkbd-keysym-process nil))
+  (setq lmkbd-keysym-pending ""))
+
+(defun lmkbd-keysym-filter (process string)
+  (setq lmkbd-keysym-pending (concat lmkbd-keysym-pending string))
+  (while (>= (length lmkbd-keysym-pending) 4)
+    (let ((id (char-to-int (aref lmkbd-keysym-pending 0)))
+          (modifiers (char-to-int (aref lmkbd-keysym-pending 1)))
+          (keysym (char-to-int (aref lmkbd-keysym-pending 2)))
+          (usage (char-to-int (aref lmkbd-keysym-pending 3))))
+      (setq lmkbd-keysym-pending (substring lmkbd-keysym-pending 4))
+      (when (= id 1)
+        (let ((event (lmkbd-keysym-event modifiers keysym usage)))
+          (when event
+            (setq unread-command-events
+                  (nconc unread-command-events (list event)))))))))
+
+(defun lmkbd-keysym-event (modifiers keysym usage)
+  (let ((key (cond ((< 0 keysym (length lmkbd-keysyms))
+                    (aref lmkbd-keysyms keysym))
+                   ((<= #x04 usage #x38)
+                    (aref lmkbd-usage-keys (- usage #x04)))))
+        (mods nil))
+    (when key
+      (when (/= 0 (logand modifiers #x10))
+        (if (and (characterp key) (/= (upcase key) key))
+            (setq key (upcase key))
+          (push 'shift mods)))
+      (when (/= 0 (logand modifiers #x01)) (push 'control mods))
+      (when (/= 0 (logand modifiers #x02)) (push 'meta mods))
+      (when (/= 0 (logand modifiers #x04)) (push 'super mods))
+      (when (/= 0 (logand modifiers #x08)) (push 'hyper mods))
+      (make-event 'key-press (list 'key key 'modifiers mods)))))